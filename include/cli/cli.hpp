@@ -6,6 +6,8 @@
 #include <string>
 #include <thread>
 #include <optional>
+#include <utility>
+#include <vector>
 #include "core/schelling_threshold.hpp"
 
 
@@ -22,6 +24,9 @@ struct Options {
 
     // Agent density in [0,1] (default set)
     double agent_density = 0.8;
+    // Fraction of agents in the minority color (color 1), in [0,1]; empty
+    // unless --minority is given (default 1/2, see sim/init.hpp)
+    std::optional<double> minority_fraction;
     // Number of experiments to run (default set)
     std::size_t experiments = 1000;
 
@@ -30,6 +35,70 @@ struct Options {
     
     // Optional maximum simulation steps; nullopt => ∞ (no cap)
     std::optional<std::size_t> max_steps;
+
+    // Optional wall-clock budget for the batch in seconds; nullopt => none
+    std::optional<double> time_limit;
+
+    // Single long run with checkpoints: file, seconds between saves, resume flag
+    std::string checkpoint_file;
+    double checkpoint_every = 600.0;
+    bool resume = false;
+
+    // Sharded batch: run shard shard_index of shard_count and write the
+    // partial result to partial_file (also written for unsharded batches)
+    std::size_t shard_index = 0;
+    std::size_t shard_count = 1;
+    std::string partial_file;
+
+    // Sequential stopping: experiments becomes a cap; stop once the relative
+    // CI half-width on the mean is <= ci_target (0 => fixed batch)
+    double ci_target = 0.0;
+    double ci_z = 1.96;
+    std::size_t wave = 32;
+
+    // Worker placement: pin to these CPUs; one arena per NUMA node
+    std::vector<int> cores;
+    bool numa = false;
+
+    // Step x unhappy-count heatmap image (PPM); empty => none
+    std::string heatmap_file;
+    std::size_t heatmap_bins = 256;
+    bool heatmap_exact = false;   // one row per step, one column per unhappy count
+
+    // Move trajectories of the record_jobs experiments to record_file (needs
+    // a build with RECORD=1); empty => none
+    std::string record_file;
+    std::vector<std::size_t> record_jobs;
+
+    // Replay mode: configuration of experiment replay_job at step replay_at,
+    // from a --record file written with the same seed and settings
+    std::string replay_file;
+    std::size_t replay_job = 0;
+    std::uint64_t replay_at = 0;
+
+    // Sweep mode (any sweep axis given): every (tau, density, size) of the
+    // grid; empty axes default to p/q, agent_density and the built-in size
+    bool sweep = false;
+    std::vector<std::pair<core::color_count_t, core::color_count_t>> sweep_tau;
+    std::vector<double> sweep_density;
+    std::vector<std::size_t> sweep_size;   // lollipop total sizes
+    std::string sweep_out;                 // PREFIX for .bin/.csv; empty => none
+    bool sweep_crn = false;                // common random numbers + paired differences
+
+    // JIT warmup mode: build these specializations into the _jit/ cache,
+    // jit_parallel compilers at a time (0 => hardware threads). Entries are
+    // lollipop sizes (jit_sizes, as clique:path) and graph type expressions
+    // from jit_header whose later calls pass jit_size_hint.
+    bool jit_warmup = false;
+    std::vector<std::pair<std::size_t, std::size_t>> jit_sizes;
+    std::vector<std::string> jit_types;
+    std::string jit_header = "graphs/lollipop.hpp";
+    std::uint64_t jit_size_hint = 0;
+    unsigned jit_parallel = 0;
+
+    // Merge mode: combine these partial-result files instead of simulating
+    bool merge = false;
+    std::vector<std::string> merge_files;
 };
 
 // Parse CLI arguments with Boost.Program_options.
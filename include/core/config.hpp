@@ -16,6 +16,39 @@
 #define CORE_BITSET_HARDENED false
 #endif
 
+// Minimum word count at which sampled PaddedBitsets (Path occupancy and
+// unhappy cache) carry a Fenwick rank/select directory. Below it, the
+// linear popcount scan of kth_one/kth_zero beats the O(log W) Fenwick
+// descent plus its per-mutation upkeep (measured crossover ~300-700 words).
+#ifndef CORE_RANK_SELECT_MIN_WORDS
+#define CORE_RANK_SELECT_MIN_WORDS 512
+#endif
+
+// Fast-forward runs of state-preserving moves in sim::run_schelling_process
+// for graphs that expose sample_effective_move (see sim/graph_concepts.hpp).
+// Hitting-time distributions are unchanged; RNG consumption differs.
+#ifndef SCHELLING_SKIP_NULL_MOVES
+#define SCHELLING_SKIP_NULL_MOVES 1
+#endif
+
+// sim::initialize_graph builds occupancy/color bitsets word-parallel and hands
+// them to bulk_load() on graphs that provide it (see sim/graph_concepts.hpp).
+// Same initial-state law as the per-agent rejection initializer.
+#ifndef SCHELLING_BULK_INIT
+#define SCHELLING_BULK_INIT 1
+#endif
+
+// Moves between polls of the stop predicate in sim::run_schelling_process_until
+// (cancellation/deadline checks inside a running job). Power of two.
+#ifndef SCHELLING_STOP_POLL_STEPS
+#define SCHELLING_STOP_POLL_STEPS 4096
+#endif
+
+// Compile in the move recorder hooks of sim::schelling_step (see
+// sim/trajectory.hpp). Off: no hook, no thread-local lookup per step.
+#ifndef SCHELLING_RECORD_TRAJECTORIES
+#define SCHELLING_RECORD_TRAJECTORIES 0
+#endif
 
 // Global hardening switch for optional runtime assertions in debug/testing code.
 // Set via compile flag: -DCORE_HARDENED=1
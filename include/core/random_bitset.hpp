@@ -0,0 +1,114 @@
+// random_bitset.hpp — word-parallel random bitsets of exact Hamming weight
+//
+// Generation is two passes:
+// 1) Bernoulli bit-composition: every bit of a word is Bernoulli(p) for p
+//    rounded to `bernoulli_bits` binary digits, built from one RNG word per
+//    digit (x = digit ? x | r : x & r, least significant digit first).
+// 2) Exact weight correction: set/clear uniformly chosen bits (rejection on
+//    random positions) until the weight is exactly k.
+// An i.i.d. Bernoulli set conditioned on its size is a uniform subset of that
+// size, and removing (adding) uniformly chosen members keeps it uniform, so
+// the result is an exactly uniform k-subset whatever the rounding of p.
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#include "core/bitset.hpp"
+#include "core/config.hpp"
+#include "core/rng.hpp"
+
+namespace core {
+
+// Precision of p in the composition; rounding only shifts work to the correction pass.
+inline constexpr unsigned bernoulli_bits = 16;
+
+// One word with i.i.d. Bernoulli(p16 / 2^bernoulli_bits) bits.
+template <class URBG>
+inline CORE_BITSET_WORD_T bernoulli_word(URBG& rng, std::uint32_t p16) noexcept {
+    using word_t = CORE_BITSET_WORD_T;
+    if (p16 == 0) return 0;
+    if (p16 >> bernoulli_bits) return ~word_t(0);
+    // Digits below the lowest set one leave x == 0: start there.
+    word_t x = 0;
+    for (unsigned d = static_cast<unsigned>(std::countr_zero(p16)); d < bernoulli_bits; ++d) {
+        const word_t r = static_cast<word_t>(rng());
+        x = ((p16 >> d) & 1u) ? (x | r) : (x & r);
+    }
+    return x;
+}
+
+inline std::uint32_t bernoulli_fixed_point(double p) noexcept {
+    if (!(p > 0.0)) return 0;
+    if (p >= 1.0) return std::uint32_t{1} << bernoulli_bits;
+    return static_cast<std::uint32_t>(p * static_cast<double>(std::uint32_t{1} << bernoulli_bits) + 0.5);
+}
+
+// Uniform k-subset of [0, n) (n <= N), bits [n, N) left clear.
+template <std::size_t N, class URBG>
+inline core::bitset<N> random_weight_bitset(std::size_t n, std::size_t k, URBG& rng) {
+    using word_t = CORE_BITSET_WORD_T;
+    constexpr std::size_t word_bits = sizeof(word_t) * 8;
+    CORE_ASSERT_H(n <= N && k <= n, "random_weight_bitset: need k <= n <= N");
+    core::bitset<N> out; // all zeros
+    if (k == 0 || n == 0) return out;
+
+    word_t* buf = out.data();
+    const std::size_t full = n / word_bits;
+    const std::uint32_t p16 = bernoulli_fixed_point(static_cast<double>(k) / static_cast<double>(n));
+    std::size_t m = 0;
+    for (std::size_t w = 0; w < full; ++w) {
+        buf[w] = bernoulli_word(rng, p16);
+        m += static_cast<std::size_t>(std::popcount(buf[w]));
+    }
+    if (const std::size_t tail = n % word_bits) {
+        buf[full] = bernoulli_word(rng, p16) & ((word_t(1) << tail) - 1);
+        m += static_cast<std::size_t>(std::popcount(buf[full]));
+    }
+
+    while (m > k) {
+        const std::size_t i = static_cast<std::size_t>(core::uniform_bounded(rng, n));
+        if (out.test(i)) { out.reset(i); --m; }
+    }
+    while (m < k) {
+        const std::size_t i = static_cast<std::size_t>(core::uniform_bounded(rng, n));
+        if (!out.test(i)) { out.set(i); ++m; }
+    }
+    return out;
+}
+
+// Uniform k-subset of the set bits of `within` (k <= within.count()).
+template <std::size_t N, class URBG>
+inline core::bitset<N> random_weight_bitset_within(const core::bitset<N>& within, std::size_t k, URBG& rng) {
+    using word_t = CORE_BITSET_WORD_T;
+    constexpr std::size_t word_bits = sizeof(word_t) * 8;
+    constexpr std::size_t words = (N + word_bits - 1) / word_bits;
+    const std::size_t n = within.count();
+    CORE_ASSERT_H(k <= n, "random_weight_bitset_within: need k <= within.count()");
+    core::bitset<N> out; // all zeros
+    if (k == 0) return out;
+    if (k == n) return within;
+
+    const word_t* mask = within.data();
+    word_t* buf = out.data();
+    const std::uint32_t p16 = bernoulli_fixed_point(static_cast<double>(k) / static_cast<double>(n));
+    std::size_t m = 0;
+    for (std::size_t w = 0; w < words; ++w) {
+        if (!mask[w]) continue;
+        buf[w] = bernoulli_word(rng, p16) & mask[w];
+        m += static_cast<std::size_t>(std::popcount(buf[w]));
+    }
+
+    while (m > k) {
+        const std::size_t i = static_cast<std::size_t>(core::uniform_bounded(rng, N));
+        if (out.test(i)) { out.reset(i); --m; }
+    }
+    while (m < k) {
+        const std::size_t i = static_cast<std::size_t>(core::uniform_bounded(rng, N));
+        if (within.test(i) && !out.test(i)) { out.set(i); ++m; }
+    }
+    return out;
+}
+
+} // namespace core
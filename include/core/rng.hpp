@@ -44,6 +44,29 @@ inline std::uint64_t splitmix_hash(std::uint64_t x) {
     return sm.next();
 }
 
+// Seed of job j in a batch keyed by `key`: the j-th output of the SplitMix64
+// stream started at key, computed directly. Any job can be seeded (or
+// replayed) from (key, j) alone, in O(1) time and memory.
+inline std::uint64_t job_seed(std::uint64_t key, std::uint64_t j) noexcept {
+    return splitmix_hash(key + j * 0x9E3779B97F4A7C15ULL);
+}
+
+// Sub-streams of one job seed, so that initialization and dynamics never
+// share draws: runs that differ only in density or tau then consume the same
+// numbers for the same purpose (common random numbers, see sim/sweep.hpp).
+enum class Stream : std::uint64_t { occupancy = 1, colors = 2, dynamics = 3 };
+
+inline std::uint64_t stream_seed(std::uint64_t seed, Stream s) noexcept {
+    return job_seed(seed, static_cast<std::uint64_t>(s));
+}
+
+// Batch key for job_seed: one draw from the master RNG. Runners seed job j
+// with job_seed(key, j) inside its task, so there is no O(J) seed vector.
+template <class SeedRng>
+inline std::uint64_t batch_key(SeedRng& master_rng) {
+    return static_cast<std::uint64_t>(master_rng());
+}
+
 // ---------------- Random utilities (integer-threshold selection) ----------------
 
 // Unbiased mapping of a 64-bit URBG output to [0, n) using Lemire's
@@ -24,6 +24,29 @@ inline PqThreshold program_threshold{}; // defaults to 1/2
 inline bool program_threshold_initialized = false;
 inline bool minority_happy_ = false; // kept for tests that inspect it
 
+/**
+ * @brief Threshold seen by is_unhappy on the calling thread: program_threshold
+ * unless a ThresholdScope is active (per-task thresholds, see sim/sweep.hpp).
+ */
+inline thread_local const PqThreshold* thread_threshold = &program_threshold;
+
+static inline const PqThreshold& current_threshold() noexcept { return *thread_threshold; }
+
+/**
+ * @brief Makes `t` the calling thread's threshold while in scope. Graphs cache
+ * unhappiness, so build or reset them under the threshold they run with.
+ */
+class ThresholdScope {
+public:
+    explicit ThresholdScope(const PqThreshold& t) noexcept : prev_(thread_threshold) { thread_threshold = &t; }
+    ThresholdScope(const ThresholdScope&) = delete;
+    ThresholdScope& operator=(const ThresholdScope&) = delete;
+    ~ThresholdScope() { thread_threshold = prev_; }
+
+private:
+    const PqThreshold* prev_;
+};
+
 /**
  * @brief Initialize program-wide threshold once; subsequent calls are no-ops.
  */
@@ -37,9 +60,9 @@ static inline void init_program_threshold(color_count_t p, color_count_t q) noex
 }
 
 /**
- * @brief Convenience function using program-wide state.
+ * @brief Convenience function using the calling thread's threshold.
  */
-static inline bool is_unhappy(color_count_t lf, color_count_t neigh) noexcept { return program_threshold.is_unhappy(lf, neigh); }
+static inline bool is_unhappy(color_count_t lf, color_count_t neigh) noexcept { return thread_threshold->is_unhappy(lf, neigh); }
 static inline bool is_minority_happy() noexcept { return minority_happy_; }
 
 } // namespace schelling
@@ -31,10 +31,32 @@ public:
     explicit Clique(count_t c0, count_t c1) noexcept
         : c0_(c0), c1_(c1) {}
 
+    void reset() noexcept { c0_ = 0; c1_ = 0; }
+
+    // Bulk load: counts over bits [offset, offset + Size) of occupancy/colors.
+    template<std::size_t N>
+    void bulk_load(const core::bitset<N>& occ, const core::bitset<N>& color, std::size_t offset = 0) noexcept {
+        static_assert(N >= Size, "Clique::bulk_load: source bitset shorter than the clique");
+        CORE_ASSERT_H(offset + Size <= N, "Clique::bulk_load: window out of range");
+        const count_t n = static_cast<count_t>(occ.count(offset, offset + Size));
+        c1_ = static_cast<count_t>((occ & color).count(offset, offset + Size));
+        c0_ = n - c1_;
+    }
+
+    // Checkpoint state: the two color counts.
+    static constexpr std::size_t state_words = 2;
+    void save_state(std::uint64_t* out) const noexcept { out[0] = c0_; out[1] = c1_; }
+    void load_state(const std::uint64_t* in) noexcept {
+        c0_ = static_cast<count_t>(in[0]);
+        c1_ = static_cast<count_t>(in[1]);
+    }
+
     inline std::optional<bool> pop_agent(index_t from) {
         CORE_ASSERT_H(from < occupied_count(), "Clique::pop_agent: index out of range");
-        if(from < c0_) { c0_--; } else { c1_--; }
-        return from >= c0_;
+        const bool c = from >= c0_;
+        c0_ -= !c;
+        c1_ -= c;
+        return c;
     }
 
     void place_agent(index_t, bool color) noexcept {
@@ -8,13 +8,24 @@
 // Notes:
 // - set_sentinels() toggles padding bits based on the SentinelsFilled template flag.
 // - random_setbit_index/random_unsetbit_index return indices in the logical window [0,B).
-// - Conversion operator to core::bitset<B> compacts out the padding.
+// - Conversion operator to core::bitset<B> compacts out the padding;
+//   window_word() + assign_words() load a B-bit slice of any bitset.
+// - RankSelect=true keeps a Fenwick tree of per-word popcounts in sync with
+//   set()/reset(), so random_setbit_index/random_unsetbit_index select in
+//   O(log W) instead of the O(W) popcount scan of kth_one/kth_zero.
 //
 #pragma once
 
+#include <array>
+#include <bit>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
+#include <random>
 #include <type_traits>
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
 #include "core/rng.hpp"
 #include "core/bitset.hpp"
 #include "core/config.hpp"
@@ -22,12 +33,77 @@
 namespace graphs {
 namespace detail {
 
-template<std::size_t B, std::size_t Padding = 2, bool SentinelsFilled = false>
+// Fenwick tree over per-word popcounts of a W-word bitset (1-based nodes).
+// Node sums are raw popcounts, padding included, matching kth_one/kth_zero ranks.
+template<std::size_t W>
+struct WordRankDirectory {
+    static constexpr std::size_t word_bits = sizeof(CORE_BITSET_WORD_T) * 8;
+    static constexpr std::size_t top = std::bit_floor(W);
+
+    std::array<std::uint32_t, W + 1> tree_{};
+
+    // O(W) bottom-up build.
+    inline void build(const CORE_BITSET_WORD_T* words) noexcept {
+        tree_[0] = 0;
+        for (std::size_t i = 1; i <= W; ++i) tree_[i] = static_cast<std::uint32_t>(std::popcount(words[i - 1]));
+        for (std::size_t i = 1; i <= W; ++i) {
+            const std::size_t parent = i + (i & (~i + 1));
+            if (parent <= W) tree_[parent] += tree_[i];
+        }
+    }
+
+    inline void add(std::size_t word, std::uint32_t delta) noexcept {
+        for (std::size_t i = word + 1; i <= W; i += i & (~i + 1)) tree_[i] += delta;
+    }
+
+    // Descend to the word holding the k-th one (k is rewritten to the in-word rank).
+    inline std::size_t select_one_word(std::size_t& k) const noexcept {
+        std::size_t pos = 0;
+        for (std::size_t step = top; step != 0; step >>= 1) {
+            const std::size_t next = pos + step;
+            if (next <= W && tree_[next] <= k) { pos = next; k -= tree_[next]; }
+        }
+        return pos;
+    }
+
+    // Zero counts follow from node spans: a node reached at `step` covers `step` words.
+    inline std::size_t select_zero_word(std::size_t& k) const noexcept {
+        std::size_t pos = 0;
+        for (std::size_t step = top; step != 0; step >>= 1) {
+            const std::size_t next = pos + step;
+            if (next <= W) {
+                const std::size_t zeros = step * word_bits - tree_[next];
+                if (zeros <= k) { pos = next; k -= zeros; }
+            }
+        }
+        return pos;
+    }
+};
+
+struct NoRankDirectory {};
+
+// Position of the k-th set bit of w (k < popcount(w)).
+inline std::size_t select_in_word(CORE_BITSET_WORD_T w, std::size_t k) noexcept {
+#if defined(__BMI2__)
+    if constexpr (sizeof(CORE_BITSET_WORD_T) == 8) {
+        return static_cast<std::size_t>(std::countr_zero(_pdep_u64(std::uint64_t{1} << k, w)));
+    }
+#endif
+    for (std::size_t i = 0; i < k; ++i) w &= (w - 1);
+    return static_cast<std::size_t>(std::countr_zero(w));
+}
+
+template<std::size_t B, std::size_t Padding = 2, bool SentinelsFilled = false, bool RankSelect = false>
 class PaddedBitset {
     using bitset = core::bitset<B + 2 * Padding>;
-    template<std::size_t, std::size_t, bool>
+    template<std::size_t, std::size_t, bool, bool>
     friend class PaddedBitset;
 
+    static constexpr std::size_t word_bits = sizeof(CORE_BITSET_WORD_T) * 8;
+    static constexpr std::size_t word_count = (B + 2 * Padding + word_bits - 1) / word_bits;
+    static_assert(!RankSelect || (B + 2 * Padding) <= 0xFFFFFFFFull, "PaddedBitset: rank directory uses 32-bit counts");
+    using directory = std::conditional_t<RankSelect, WordRankDirectory<word_count>, NoRankDirectory>;
+
 public:
     PaddedBitset() noexcept {
         // Ensure a fully zero-initialized backing store, then establish
@@ -71,7 +147,7 @@ public:
     }
 
     template<bool OtherSentinels, std::enable_if_t<OtherSentinels != SentinelsFilled, int> = 0>
-    PaddedBitset(const PaddedBitset<B, Padding, OtherSentinels>& other) noexcept {
+    PaddedBitset(const PaddedBitset<B, Padding, OtherSentinels, RankSelect>& other) noexcept {
         data_ = other.data_;
         apply_sentinels();
         update_count_cache();
@@ -89,8 +165,20 @@ public:
     inline bool operator[](std::size_t idx) const noexcept { return data_[map_index_(idx)]; }
     // Equality operators are intentionally omitted to keep the surface minimal; compare raw() if needed in tests.
 
+    // Clear every bit (memset over the live words), then restore sentinels and caches.
+    inline void reset() noexcept {
+        if constexpr (word_count != 0) {
+            std::memset(data_.data(), 0, word_count * sizeof(CORE_BITSET_WORD_T));
+        }
+        apply_sentinels();
+        if constexpr (RankSelect) dir_.build(data_.data());
+        count_cache_ = 0;
+        padding_ones_left = SentinelsFilled ? Padding : 0;
+    }
+
     inline void reset(std::size_t idx) noexcept {
         const std::size_t raw = map_index_(idx);
+        if constexpr (RankSelect) dir_.add(raw / word_bits, static_cast<std::uint32_t>(0) - data_[raw]);
         if (raw >= Padding && raw < Padding + B) {   // inside active window
             count_cache_ -= data_[raw];
         } else {
@@ -101,6 +189,7 @@ public:
 
     inline void set(std::size_t idx) noexcept {
         const std::size_t raw = map_index_(idx);
+        if constexpr (RankSelect) dir_.add(raw / word_bits, !data_[raw]);
         if (raw >= Padding && raw < Padding + B) [[likely]] {   // inside active window
             count_cache_ += !data_[raw];
         } else {
@@ -151,19 +240,74 @@ public:
 
     inline const bitset& raw() const noexcept { return data_; }
 
+    // ---------------- Word-level access (raw layout, padding included) ----------------
+    static constexpr std::size_t words = word_count;
+    inline CORE_BITSET_WORD_T word(std::size_t w) const noexcept { return data_.data()[w]; }
+
+    // Overwrite the bits selected by `mask` in raw word `w`; counts and directory follow the delta.
+    inline void assign_word_bits(std::size_t w, CORE_BITSET_WORD_T mask, CORE_BITSET_WORD_T bits) noexcept {
+        CORE_BITSET_WORD_T* buf = data_.data();
+        const CORE_BITSET_WORD_T old = buf[w];
+        const CORE_BITSET_WORD_T next = (old & ~mask) | (bits & mask);
+        const CORE_BITSET_WORD_T active = active_mask_(w);
+        count_cache_ += static_cast<std::size_t>(std::popcount(next & active)) - static_cast<std::size_t>(std::popcount(old & active));
+        padding_ones_left += static_cast<std::size_t>(std::popcount(next & ~active)) - static_cast<std::size_t>(std::popcount(old & ~active));
+        if constexpr (RankSelect) {
+            dir_.add(w, static_cast<std::uint32_t>(std::popcount(next)) - static_cast<std::uint32_t>(std::popcount(old)));
+        }
+        buf[w] = next;
+    }
+
+    // Refill every raw word from word_at(w), then restore sentinels and caches in one pass.
+    template<class WordFn>
+    inline void assign_words(WordFn&& word_at) noexcept {
+        CORE_BITSET_WORD_T* buf = data_.data();
+        for (std::size_t w = 0; w < word_count; ++w) buf[w] = word_at(w);
+        if constexpr ((B + 2 * Padding) % word_bits != 0) {
+            buf[word_count - 1] &= ~CORE_BITSET_WORD_T(0) >> (word_bits - (B + 2 * Padding) % word_bits);
+        }
+        apply_sentinels();
+        update_count_cache();
+        padding_ones_left = SentinelsFilled ? Padding : 0;
+    }
+
+    // Raw word w of the window holding bits [offset, offset + B) of src, padding zeroed.
+    // Pair with assign_words() to bulk-load a slice of a larger bitset.
+    template<std::size_t OB>
+    static inline CORE_BITSET_WORD_T window_word(const core::bitset<OB>& src, std::size_t offset, std::size_t w) noexcept {
+        constexpr std::size_t src_words = (OB + word_bits - 1) / word_bits;
+        const CORE_BITSET_WORD_T* s = src.data();
+        // Raw bit r reads src bit offset + r - Padding; bias by one word so the
+        // left padding of word 0 (negative source positions) stays unsigned.
+        const std::size_t biased = w * word_bits + offset + word_bits - Padding;
+        const std::size_t q = biased / word_bits;   // source word + 1
+        const std::size_t sh = biased % word_bits;
+        const CORE_BITSET_WORD_T lo = (q >= 1 && q - 1 < src_words) ? s[q - 1] : 0;
+        const CORE_BITSET_WORD_T hi = (q < src_words) ? s[q] : 0;
+        const CORE_BITSET_WORD_T bits = sh ? ((lo >> sh) | (hi << (word_bits - sh))) : lo;
+        return bits & active_mask_(w);
+    }
+
     template<class URBG>
     std::size_t random_setbit_index(URBG& rng) const noexcept {
         std::uniform_int_distribution<std::size_t> pick(0, count() - 1u);
         const std::size_t k = pick(rng) + padding_ones_left;
-        auto ret = data_.kth_one(k) - Padding;
-        return ret;
+        if constexpr (RankSelect) {
+            return kth_one_indexed_(k) - Padding;
+        } else {
+            return data_.kth_one(k) - Padding;
+        }
     }
 
     template<class URBG>
     std::size_t random_unsetbit_index(URBG& rng) const noexcept {
         std::uniform_int_distribution<std::size_t> pick(0, B - count() - 1u);
         const std::size_t k = pick(rng) + (Padding - padding_ones_left);
-        return data_.kth_zero(k) - Padding;
+        if constexpr (RankSelect) {
+            return kth_zero_indexed_(k) - Padding;
+        } else {
+            return data_.kth_zero(k) - Padding;
+        }
     }
 
     // Rejection-sampling variants (expected O(1) when target fraction is constant).
@@ -189,16 +333,39 @@ public:
 private:
     inline void apply_sentinels() noexcept {
         if constexpr (Padding == 0)  return; 
+        // plf ranges are [begin, end)
         if constexpr (SentinelsFilled) {
-            data_.set_range(0, Padding - 1);
-            data_.set_range(B + Padding, B + 2 * Padding - 1);
+            data_.set_range(0, Padding);
+            data_.set_range(B + Padding, B + 2 * Padding);
         } else {
-            data_.reset_range(0, Padding - 1);
-            data_.reset_range(B + Padding, B + 2 * Padding - 1);
+            data_.reset_range(0, Padding);
+            data_.reset_range(B + Padding, B + 2 * Padding);
         }
     }
 
+    // Bits of raw word w that fall inside the logical window [Padding, Padding + B).
+    static constexpr CORE_BITSET_WORD_T active_mask_(std::size_t w) noexcept {
+        const std::size_t lo = w * word_bits;
+        const std::size_t begin = (Padding > lo) ? Padding - lo : 0;
+        const std::size_t end = (Padding + B < lo + word_bits) ? ((Padding + B > lo) ? Padding + B - lo : 0) : word_bits;
+        if (begin >= end) return 0;
+        const CORE_BITSET_WORD_T upper = (end == word_bits) ? ~CORE_BITSET_WORD_T(0) : ((CORE_BITSET_WORD_T(1) << end) - 1);
+        return upper & (~CORE_BITSET_WORD_T(0) << begin);
+    }
+
+    // Directory-backed selects; same ranks as bitset::kth_one/kth_zero.
+    inline std::size_t kth_one_indexed_(std::size_t k) const noexcept {
+        const std::size_t w = dir_.select_one_word(k);
+        return w * word_bits + select_in_word(data_.data()[w], k);
+    }
+
+    inline std::size_t kth_zero_indexed_(std::size_t k) const noexcept {
+        const std::size_t w = dir_.select_zero_word(k);
+        return w * word_bits + select_in_word(static_cast<CORE_BITSET_WORD_T>(~data_.data()[w]), k);
+    }
+
     inline void update_count_cache() noexcept {
+        if constexpr (RankSelect) dir_.build(data_.data());
         count_cache_ = data_.count();
         if constexpr (Padding != 0) {
             for (std::size_t i = 0; i < Padding; ++i) {
@@ -209,6 +376,7 @@ private:
     }
 
     bitset data_{};
+    [[no_unique_address]] directory dir_{};
     std::size_t count_cache_ = static_cast<std::size_t>(-1);
     std::size_t padding_ones_left{0};
 };
@@ -1,8 +1,10 @@
 // LollipopGraph — composite graph (clique + path) with a single bridge
 #pragma once
 
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <limits>
 #include "core/rng.hpp"
 #include "core/schelling_threshold.hpp"
 #include "graphs/clique.hpp"
@@ -65,7 +67,9 @@ public:
     inline bool pop_agent(size_t from) noexcept {
         CORE_ASSERT_H(from < TotalSize, "LollipopGraph::pop_agent: index out of range");
         CORE_ASSERT_H(is_occupied(from), "LollipopGraph::pop_agent: vertex not occupied");
-        if (from == bridge_index_()) [[unlikely]] {
+        // Bridge test is limited to clique indices: with the bridge vacant and
+        // the clique counts full, bridge_index_() == PathBase (path vertex 0).
+        if (from < CliqueSize && from == bridge_index_()) [[unlikely]] {
             bool c = bridge_color_;
             clique_.pop_agent(from);
             path_.set_sentinel(0,0);
@@ -83,8 +87,8 @@ public:
         CORE_ASSERT_H(to < TotalSize, "LollipopGraph::place_agent: index out of range");
         CORE_ASSERT_H(!is_occupied(to), "LollipopGraph::place_agent: vertex already occupied");
 
-        // Original bridge-branch based on bridge_index_()
-        if (to == bridge_index_()) [[unlikely]] {
+        // Original bridge-branch based on bridge_index_(), limited to clique indices
+        if (to < CliqueSize && to == bridge_index_()) [[unlikely]] {
             path_.set_sentinel(true,c);
             clique_.place_agent(to, c);
             bridge_occupied_ = true;
@@ -96,6 +100,94 @@ public:
         }
     }
 
+    // Back to the default-constructed (empty) state without reallocating.
+    inline void reset() noexcept {
+        clique_.reset();
+        path_.reset();
+        bridge_occupied_ = false;
+        bridge_color_    = false;
+    }
+
+    // Bulk load from TotalSize-bit occupancy/color bitsets in the flat index
+    // layout: bits [0, CliqueSize) feed the clique counts, the rest the path.
+    // Clique vertex CliqueSize-1 (adjacent to path vertex 0) is the bridge.
+    inline void bulk_load(const core::bitset<TotalSize>& occ, const core::bitset<TotalSize>& col) noexcept {
+        clique_.bulk_load(occ, col, CliqueBase);
+        path_.bulk_load(occ, col, PathBase);
+        bridge_occupied_ = occ.test(CliqueSize - 1);
+        bridge_color_    = bridge_occupied_ && col.test(CliqueSize - 1);
+        path_.set_sentinel(bridge_occupied_, bridge_color_);
+    }
+
+    // Checkpoint state: clique counts, path words, then the bridge flags.
+    static constexpr size_t state_words = Clique<CliqueSize>::state_words + Path<PathLength>::state_words + 1;
+
+    inline void save_state(std::uint64_t* out) const noexcept {
+        clique_.save_state(out);
+        path_.save_state(out + Clique<CliqueSize>::state_words);
+        out[state_words - 1] = std::uint64_t{bridge_occupied_} | (std::uint64_t{bridge_color_} << 1);
+    }
+
+    inline void load_state(const std::uint64_t* in) noexcept {
+        clique_.load_state(in);
+        path_.load_state(in + Clique<CliqueSize>::state_words);
+        bridge_occupied_ = in[state_words - 1] & 1u;
+        bridge_color_    = (in[state_words - 1] >> 1) & 1u;
+        path_.set_sentinel(bridge_occupied_, bridge_color_);
+    }
+
+    // Null-move fast-forward.
+    // A step whose source is a non-bridge unhappy clique agent and whose target
+    // is a clique vacancy leaves (c0,c1), the bridge and the path unchanged.
+    // With the step's own pick weights
+    //   U = w_clique + w_path + w_bridge     (get_unhappy)
+    //   V = V_clique + V_path                (get_unoccupied)
+    //   N = (w_clique - b) * V_clique        b = bridge among the clique picks
+    // the run of null steps before the next effective one is
+    // Geometric(1 - N/(U*V)). Draws that run length, then samples (from,to)
+    // conditioned on the step being effective. Returns the number of null
+    // steps skipped, or max() if every step is null (the process never settles).
+    template<class Rng>
+    inline std::uint64_t sample_effective_move(Rng& rng, size_t& from, size_t& to) const {
+        const std::uint64_t wc = static_cast<std::uint64_t>(clique_.unhappy_count());
+        const std::uint64_t wp = static_cast<std::uint64_t>(path_.unhappy_count());
+        const std::uint64_t wb = static_cast<std::uint64_t>(bridge_unhappy() != bridge_unhappy_in_clique_sense_());
+        const std::uint64_t b  = static_cast<std::uint64_t>(bridge_unhappy_in_clique_sense_());
+        const std::uint64_t vc = static_cast<std::uint64_t>(clique_.count_by_color(std::nullopt));
+        const std::uint64_t vp = static_cast<std::uint64_t>(path_.count_by_color(std::nullopt));
+
+        const std::uint64_t total = (wc + wp + wb) * (vc + vp);
+        const std::uint64_t null  = (wc - b) * vc;
+        if (null == total) return std::numeric_limits<std::uint64_t>::max();
+
+        // One integer draw over all (from,to) pairs: effective pairs first,
+        // split (clique non-bridge, path vacancy) | (bridge/path source, any
+        // vacancy). Only a null draw pays for the geometric tail: by
+        // memorylessness the run is then 1 + Geometric and a fresh draw over
+        // the effective pairs picks the move.
+        const std::uint64_t eff_a = (wc - b) * vp;
+        const std::uint64_t eff   = total - null;
+        std::uint64_t u = core::uniform_bounded(rng, total);
+        std::uint64_t skipped = 0;
+        if (u >= eff) {
+            // Inverse CDF: floor(log v / log(N/(U*V))), v uniform in (0,1].
+            const double v = static_cast<double>((rng() >> 11) + 1) * 0x1.0p-53;
+            const double log_null = std::log1p(-static_cast<double>(eff) / static_cast<double>(total));
+            skipped = 1 + static_cast<std::uint64_t>(std::floor(std::log(v) / log_null));
+            u = core::uniform_bounded(rng, eff);
+        }
+
+        if (u < eff_a) {
+            const size_t bridge = bridge_index_();
+            do { from = clique_.get_unhappy(rng).value(); } while (b && from == bridge);
+            to = path_.get_unoccupied(rng) + PathBase;
+        } else {
+            from = core::weighted_pick2(rng, b + wb, wp) ? (path_.get_unhappy(rng) + PathBase) : bridge_index_();
+            to = get_unoccupied(rng);
+        }
+        return skipped;
+    }
+
 private:
     // ----------------------------- Helpers -----------------------------
 
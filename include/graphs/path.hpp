@@ -4,8 +4,12 @@
 // - Padded bitset backend supplies guard cells so neighbor reads (v-1,v+1)
 //   need no branches.
 // - Unhappy mask is derived from edge mismatches via bitwise lifts; per-op
-//   updates touch only a 3-cell window around the mutation.
-// - Random picks use kth-zero/one selection for uniformity without scans.
+//   updates re-run the same word kernel on the 1–2 words covering the 3-cell
+//   window around the mutation (define PATH_SCALAR_UNHAPPY_UPDATE=1 to fall
+//   back to per-vertex is_unhappy checks, e.g. for benchmarking).
+// - Random picks use kth-zero/one selection for uniformity without scans;
+//   large paths (>= CORE_RANK_SELECT_MIN_WORDS words) select through the
+//   padded bitset's Fenwick rank directory in O(log W).
 // - Counts/bitset-first; no adjacency or per-vertex storage.
 // - set_sentinel() toggles a boundary via logical index -1 addressing the left padding.
 
@@ -26,21 +30,62 @@ namespace graphs { namespace test { template<std::size_t B> struct PathAccess; }
 
 template<core::size_t B = 60>
 class Path {
-    using padded_bitset = graphs::detail::PaddedBitset<B>;
+    using word_t = CORE_BITSET_WORD_T;
+    static constexpr std::size_t word_bits = sizeof(word_t) * 8;
+    static constexpr std::size_t padded_words = (B + 4 + word_bits - 1) / word_bits;
+    using padded_bitset = graphs::detail::PaddedBitset<B, 2, false, (padded_words >= CORE_RANK_SELECT_MIN_WORDS)>;
+    using color_bitset  = graphs::detail::PaddedBitset<B>; // never sampled: no rank directory
 
 public:
     using size_t = core::size_t;
     using count_t = core::count_t;
+    static constexpr size_t TotalSize = B;
     // Grant test-only accessor friend rights when enabled.
     #if SCHELLING_TEST_ACCESSORS
     friend struct graphs::test::PathAccess<B>;
     #endif
     Path() {
-        unhappy_mask_cache_ = unhappy_mask_();
+        recompute_unhappy_mask_();
     }
     Path(const core::bitset<B>& unocc, const core::bitset<B>& col)
         : occ_(padded_bitset(~unocc)), col_(col) {
-        unhappy_mask_cache_ = unhappy_mask_();
+        recompute_unhappy_mask_();
+    }
+
+    // Bulk load from bits [offset, offset + B) of occupancy/color bitsets: one
+    // word pass per bitset plus one unhappy recompute. Colors of vacant cells
+    // are dropped; the bridge sentinel is cleared (callers re-set it).
+    template<std::size_t N>
+    void bulk_load(const core::bitset<N>& occ, const core::bitset<N>& col, std::size_t offset = 0) noexcept {
+        static_assert(N >= B, "Path::bulk_load: source bitset shorter than the path");
+        CORE_ASSERT_H(offset + B <= N, "Path::bulk_load: window out of range");
+        occ_.assign_words([&](std::size_t w) { return padded_bitset::window_word(occ, offset, w); });
+        col_.assign_words([&](std::size_t w) { return color_bitset::window_word(col, offset, w) & occ_.word(w); });
+        recompute_unhappy_mask_();
+    }
+
+    // Back to the default-constructed state (empty, no sentinel) in O(words).
+    void reset() noexcept {
+        occ_.reset();
+        col_.reset();
+        unhappy_mask_cache_.reset(); // an empty path has no unhappy vertices
+    }
+
+    // Checkpoint state: raw occupancy words then raw color words. Loading
+    // streams both back word by word and recomputes the unhappy mask; the
+    // bridge sentinel is cleared (callers re-set it), as in bulk_load().
+    static constexpr std::size_t state_words = 2 * padded_bitset::words;
+    static_assert(color_bitset::words == padded_bitset::words && sizeof(word_t) == sizeof(std::uint64_t));
+
+    void save_state(std::uint64_t* out) const noexcept {
+        for (std::size_t w = 0; w < padded_bitset::words; ++w) out[w] = occ_.word(w);
+        for (std::size_t w = 0; w < padded_bitset::words; ++w) out[padded_bitset::words + w] = col_.word(w);
+    }
+
+    void load_state(const std::uint64_t* in) noexcept {
+        occ_.assign_words([&](std::size_t w) { return in[w]; });
+        col_.assign_words([&](std::size_t w) { return in[padded_bitset::words + w]; });
+        recompute_unhappy_mask_();
     }
 
     // -------------------- Counts --------------------------------------
@@ -72,15 +117,14 @@ public:
         return unhappy_mask_cache_.random_setbit_index(rng);
     }
 
-    // Pop agent; maintain unhappy cache via local 3-cell reset/update.
+    // Pop agent; refresh the unhappy cache over the 3-cell window.
     bool pop_agent(size_t from) noexcept {
         CORE_ASSERT_H(from < B, "Path::pop_agent: index out of range");
         CORE_ASSERT_H(occ_[from], "Path::pop_agent: vertex not occupied");
         bool c = col_[from];
-        local_unhappy_reset(from);
         occ_.reset(from);
         col_.reset(from);
-        local_unhappy_update(from);
+        local_unhappy_refresh(from);
         return c;
     }
 
@@ -88,10 +132,9 @@ public:
     void place_agent(size_t to, bool c) noexcept {
         CORE_ASSERT_H(to < B, "Path::place_agent: index out of range");
         CORE_ASSERT_H(!occ_[to], "Path::place_agent: vertex already occupied");
-        local_unhappy_reset(to);
         occ_.set(to);
         if(c) col_.set(to);
-        local_unhappy_update(to);
+        local_unhappy_refresh(to);
     }
 
     // -------------------- Basic accessors -----------------------------------
@@ -103,7 +146,6 @@ public:
     // NOTE: relies on addressing left padding via logical index -1.
     // TODO: Revisit negative index mapping; consider a dedicated API surface.
     inline void set_sentinel(size_t occ, size_t col) {
-        local_unhappy_reset(0);
         if(occ) {
             occ_.set(-1); 
             if(col) col_.set(-1); 
@@ -111,7 +153,7 @@ public:
         } else {
             occ_.reset(-1); col_.reset(-1);
         }
-        local_unhappy_update(0);
+        local_unhappy_refresh(0);
     }
 
     // Testing hooks moved behind SCHELLING_TEST_ACCESSORS in
@@ -119,14 +161,15 @@ public:
     // runtime API surface.
 
  private:
-    padded_bitset occ_, col_, unhappy_mask_cache_;
+    padded_bitset occ_, unhappy_mask_cache_;
+    color_bitset  col_;
 
     inline uint8_t local_frustration(const size_t v) const { return (disagree_right(v) + disagree_left(v)); }
     inline bool disagree_left(const size_t v) const { return occ_[v] && occ_[v-1] && (col_[v] != col_[v-1]); }
     inline bool disagree_right(const size_t v) const { return occ_[v] && occ_[v+1] && (col_[v] != col_[v+1]); }
     inline uint_fast8_t neighbors(const size_t v) const { return occ_[v-1] + occ_[v+1]; }
 
-    // Only called for idx <= B-1
+    // Scalar fallback (PATH_SCALAR_UNHAPPY_UPDATE). Only called for idx <= B-1
     void local_unhappy_reset(const size_t idx) {
         unhappy_mask_cache_.reset(idx-1);
         unhappy_mask_cache_.reset(idx);
@@ -135,27 +178,66 @@ public:
 
     // Update cached mask over window [idx-1, idx, idx+1].
     void local_unhappy_update(const size_t idx) {
-        // TODO Optimize this function by noting we only need to check minority/majority cases
-        // in the 3-cell window, not full unhappy_mask_() recompute.
         if(is_unhappy(idx-1))  unhappy_mask_cache_.set(idx-1);
         if(is_unhappy(idx))    unhappy_mask_cache_.set(idx);
         if(is_unhappy(idx+1))  unhappy_mask_cache_.set(idx+1);
     }
 
-    // Full recompute: derive vertex-unhappy mask from edge incidence and
-    // color differences, avoiding per-vertex branching.
-    inline padded_bitset unhappy_mask_() const {
-        // unhappy(d,n): true iff d/n > τ (τ = p/q)
-        const bool one_mismatch_unhappy = core::schelling::is_unhappy(1, 2); // true iff τ < 1/2
+    // Refresh cached unhappy bits over [idx-1, idx+1] after a mutation at idx.
+    void local_unhappy_refresh(const size_t idx) noexcept {
+#if defined(PATH_SCALAR_UNHAPPY_UPDATE) && PATH_SCALAR_UNHAPPY_UPDATE
+        local_unhappy_reset(idx);
+        local_unhappy_update(idx);
+#else
+        // Word-level: rerun the full-recompute kernel on the word(s) holding
+        // raw cells [raw-1, raw+1] and splice back only those three bits.
+        const std::size_t raw   = static_cast<std::size_t>(idx) + 2;
+        const std::size_t shift = (raw - 1) % word_bits;
+        const std::size_t w_lo  = (raw - 1) / word_bits;
+        const std::size_t w_hi  = (raw + 1) / word_bits;
+        const word_t any  = word_t(0) - core::schelling::is_unhappy(1, 2);
+        const word_t some = word_t(0) - core::schelling::is_unhappy(1, 1);
+        unhappy_mask_cache_.assign_word_bits(w_lo, word_t(7) << shift, unhappy_word_(w_lo, any, some));
+        if (w_hi != w_lo) {
+            unhappy_mask_cache_.assign_word_bits(w_hi, word_t(7) >> (word_bits - shift), unhappy_word_(w_hi, any, some));
+        }
+#endif
+    }
 
-        const auto e    = occ_ & (occ_ << 1);      // edges (i-1,i), anchored at i
-        const auto diff = col_ ^ (col_ << 1);      // color-difference on edges
-        const auto mis  = e & diff;                // mismatching edges only
-        const auto match = e & ~diff;              // matching edges only
-        auto lift = [](const padded_bitset& x) { return x | (x >> 1); }; // edge → incident vertices
+    // Edge/lift kernel for raw word w of the unhappy mask. Reads occupancy and
+    // colors of words w-1..w+1 so shifts carry across word boundaries.
+    //   e     = occ & (occ << 1)     edges (i-1,i), anchored at i
+    //   diff  = col ^ (col << 1)     color difference on edges
+    //   lift  = x | (x >> 1)         edge -> incident vertices
+    // any  (all ones iff τ < 1/2): one mismatch suffices -> lift(e & diff)
+    // else                       : neighbor and no match -> lift(e) & ~lift(e & ~diff)
+    // some (all ones iff τ < 1)  : otherwise nobody is ever unhappy.
+    inline word_t unhappy_word_(std::size_t w, word_t any, word_t some) const noexcept {
+        constexpr std::size_t top = word_bits - 1;
+        const bool has_prev = w != 0;
+        const bool has_next = w + 1 < padded_bitset::words;
+        const word_t o  = occ_.word(w);
+        const word_t c  = col_.word(w);
+        const word_t op = has_prev ? occ_.word(w - 1) : 0;
+        const word_t cp = has_prev ? col_.word(w - 1) : 0;
+        const word_t on = has_next ? occ_.word(w + 1) : 0;
+        const word_t cn = has_next ? col_.word(w + 1) : 0;
+
+        const word_t e     = o  & ((o  << 1) | (op >> top));
+        const word_t e_n   = on & ((on << 1) | (o  >> top));
+        const word_t diff  = c  ^ ((c  << 1) | (cp >> top));
+        const word_t diffn = cn ^ ((cn << 1) | (c  >> top));
+        auto lift = [](word_t x, word_t x_next) { return x | (x >> 1) | (x_next << top); };
+
+        const word_t mis_lift   = lift(e & diff, e_n & diffn);
+        const word_t match_lift = lift(e & ~diff, e_n & ~diffn);
+        return some & ((any & mis_lift) | (~any & lift(e, e_n) & ~match_lift));
+    }
 
-        // τ < 1/2 : any mismatch makes you unhappy
-        // τ ≥ 1/2 : unhappy if you have a neighbor and none match
-        return one_mismatch_unhappy ? lift(mis) : (lift(e) & ~lift(match));
+    // Full recompute: one word-kernel pass over the whole mask.
+    inline void recompute_unhappy_mask_() noexcept {
+        const word_t any  = word_t(0) - core::schelling::is_unhappy(1, 2);
+        const word_t some = word_t(0) - core::schelling::is_unhappy(1, 1);
+        unhappy_mask_cache_.assign_words([&](std::size_t w) { return unhappy_word_(w, any, some); });
     }
 };
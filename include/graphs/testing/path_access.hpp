@@ -7,7 +7,7 @@
 #if SCHELLING_TEST_ACCESSORS
 
 #include "graphs/path.hpp"
-#include "core/plf_bitset.h"
+#include "third_party/plf_bitset.h"
 
 namespace graphs { namespace test {
 
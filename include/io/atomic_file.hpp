@@ -0,0 +1,100 @@
+// io/atomic_file.hpp — crash-safe whole-file replacement
+//
+// atomic_write_file(file, fill) has fill(std::ostream&) write "<file>.tmp",
+// fsyncs it, renames it over <file> and fsyncs the directory. After a crash
+// or power loss <file> holds either its previous contents or the new ones,
+// never an empty or torn file.
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <filesystem>
+#include <ostream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace io {
+
+namespace detail {
+
+// Buffered output streambuf over a file descriptor (not owned).
+class FdBuf : public std::streambuf {
+public:
+    explicit FdBuf(int fd) noexcept : fd_(fd) { setp(buf_, buf_ + sizeof buf_); }
+    bool ok() const noexcept { return ok_; }
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (!drain_()) return traits_type::eof();
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+    int sync() override { return drain_() ? 0 : -1; }
+
+private:
+    bool drain_() noexcept {
+        for (const char* p = pbase(); p != pptr();) {
+            const ::ssize_t n = ::write(fd_, p, static_cast<std::size_t>(pptr() - p));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) { ok_ = false; break; }
+            p += n;
+        }
+        setp(buf_, buf_ + sizeof buf_);
+        return ok_;
+    }
+
+    int  fd_;
+    bool ok_{true};
+    char buf_[std::size_t{1} << 16];
+};
+
+// Make a rename in `dir` durable (best effort: some filesystems refuse).
+inline void fsync_dir(const std::filesystem::path& dir) noexcept {
+    const int fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return;
+    ::fsync(fd);
+    ::close(fd);
+}
+
+} // namespace detail
+
+// Replace `file` with what fill(std::ostream&) writes; throws if any step fails
+// (the temp file is removed and `file` left as it was).
+template <class Fill>
+inline void atomic_write_file(const std::filesystem::path& file, Fill&& fill) {
+    std::filesystem::path tmp = file;
+    tmp += ".tmp";
+    const int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) throw std::runtime_error("cannot create " + tmp.string());
+    bool ok = false;
+    try {
+        detail::FdBuf buf(fd);
+        std::ostream out(&buf);
+        fill(out);
+        out.flush();
+        ok = out && buf.ok() && ::fsync(fd) == 0;
+    } catch (...) {
+        ::close(fd);
+        std::error_code ec;
+        std::filesystem::remove(tmp, ec);
+        throw;
+    }
+    ok = (::close(fd) == 0) && ok;
+    if (!ok) {
+        std::error_code ec;
+        std::filesystem::remove(tmp, ec);
+        throw std::runtime_error("cannot write " + tmp.string());
+    }
+    std::filesystem::rename(tmp, file);
+    detail::fsync_dir(file.parent_path());
+}
+
+} // namespace io
@@ -8,6 +8,9 @@
 // (src/jit/jit.cpp) generates a tiny C++ translation unit that includes
 // the requested graph header, constructs the requested graph type, compiles
 // it into a shared object, then loads and executes it via dlopen/dlsym.
+// Each shared object exports two entry points: `run_once` (one process,
+// fixed seed) and `run_batch` (many jobs, TBB-parallel inside the library,
+// see run_graph_batch).
 //
 // Why JIT?
 // --------
@@ -15,21 +18,29 @@
 // (no runtime branches). JIT lets users pick graph types/sizes at runtime
 // while preserving the performance of static specialization. The first run
 // for a given (Graph type expression) incurs a one‑time compile; subsequent
-// runs reuse the cached .so.
+// runs, in this process or any other, reuse the cached .so.
 //
 // File layout & cache
 // -------------------
-// Generated code and shared objects live under `_jit/` using a stable
-// naming scheme derived from the graph type expression, e.g.,
-// `g_<sanitized-typename>.cpp/.so`. The generator always rewrites the
-// source file to reflect current templates, and we rebuild the .so if it
-// is missing or older than the source.
+// Generated code and shared objects live under `_jit/` as
+// `g_<sanitized-typename>-<key>.cpp/.so`, where <key> is a 128-bit hash of
+// the generated source, the CORE_INDEX_T choice, the compiler identity
+// (`$CXX --version`), the full build command, what `-march=native` resolves
+// to on this host (compiler target options, CPU model and flags), the
+// contents of every header under include/, and the requested graph header
+// wherever it lives. An existing .so with that name is loaded without
+// compiling; any change to those inputs yields a new name. Builds write to
+// a per-process temp file that is renamed into place, so a .so is never
+// seen half-written. Stale entries are never reused; `make purge` clears
+// them.
 //
 // Toolchain & flags
 // -----------------
 // The compiler is taken from $CXX if set, else `c++`. The .so is built
 // with the appropriate platform flags (see src/jit/jit.cpp) and includes
-// this repository's headers via `-Iinclude ...`. The JIT also defines
+// this repository's headers via `-Iinclude ...`; on Linux with
+// `-ftls-model=initial-exec`, so the per-thread threshold read on the hot
+// path is a plain load as in a static build. The JIT also defines
 // `CORE_INDEX_T` (see include/core/config.hpp), chosen per specialization.
 // Heuristic favors throughput: 32-bit where it fits, else 64-bit.
 //
@@ -41,8 +52,17 @@
 //
 // Threading
 // ---------
-// The JIT path is not made thread‑safe. Concurrent calls might race on
-// `_jit/<name>.cpp/.so`. Prefer serializing JIT invocations per size.
+// Entry points are thread-safe. A process-wide registry maps each
+// (header, type expression, CORE_INDEX_T) to its loaded library: the first
+// call builds and loads it once while concurrent callers for the same key
+// wait, and later calls from any thread reuse the handle (libraries stay
+// loaded until exit). A failed build or load is remembered for the life of
+// the process. Across processes, builds of one key are serialized by an
+// advisory lock on `_jit/<name>-<key>.lock`, so a waiting process finds the
+// finished .so instead of compiling it again. Calls with different
+// thresholds run concurrently, run_batch ones included: each job sets its
+// threshold on the worker running it (ThresholdScope), never the
+// program-wide one.
 //
 // Security note
 // -------------
@@ -61,6 +81,8 @@
 //  3: compile failure (non‑zero compiler exit)
 //  4: dlopen failed
 //  5: dlsym failed (entry symbol not found)
+// Codes returned by the kernel itself (e.g. 2 if run_batch throws) pass
+// through unchanged.
 //
 // Usage (examples)
 // ---------------
@@ -74,11 +96,23 @@
 //   unsigned long long m=0, fu=0;
 //   int rc2 = jit::run_graph_once("graphs/my.hpp", "my::MyGraph<64>", 1, 2, 0.8, m, fu);
 //   (void)rc2;
+//
+// Batch of jobs, one load, all cores, at most 10^7 steps per job and 60 s:
+//   std::vector<std::uint64_t> times;
+//   int rc3 = jit::run_lollipop_batch(50, 450, 1, 2, 0.8, 42, 1000, 0, 10'000'000, 60.0, times);
+//
+// Precompile a sweep's sizes up front, 8 compilers at a time:
+//   std::vector<jit::WarmupEntry> grid;
+//   for (std::size_t cs : {5, 10, 50}) grid.push_back(jit::lollipop_entry(cs, 9 * cs));
+//   for (const auto& r : jit::warmup(grid, 8)) { /* r.status, r.cached, r.seconds */ }
+//   (lollipop --jit-warmup 5:45,10:90,50:450 --jit-parallel 8 does the same.)
 #pragma once
 
 #include <cstddef>
 #include <cstdint>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace jit {
 
@@ -106,7 +140,22 @@ int run_lollipop_once(std::size_t clique_size,
                       unsigned long long& final_unhappy_out,
                       std::string* build_log = nullptr);
 
-} // namespace jit
+/**
+ * Batched counterpart of run_lollipop_once; see run_graph_batch().
+ */
+int run_lollipop_batch(std::size_t clique_size,
+                       std::size_t path_length,
+                       std::uint64_t p,
+                       std::uint64_t q,
+                       double density,
+                       std::uint64_t master_seed,
+                       std::size_t jobs,
+                       int threads,
+                       std::uint64_t max_steps,
+                       double time_limit,
+                       std::vector<std::uint64_t>& times_out,
+                       std::string* build_log = nullptr);
+
 /**
  * Compile and run a single Schelling process for an arbitrary GraphLike type.
  *
@@ -117,7 +166,8 @@ int run_lollipop_once(std::size_t clique_size,
  * @param density          Initialization density in [0,1].
  * @param moves_out        Output: number of moves performed.
  * @param final_unhappy_out Output: terminal unhappy_count.
- * @param build_log        Optional: receives the compiler command used.
+ * @param build_log        Optional: receives the compiler command used, or
+ *                         "cached <path>" when the .so was reused.
  * @return                 0 on success; non‑zero on failure.
  */
 int run_graph_once(std::string_view include_header,
@@ -129,3 +179,65 @@ int run_graph_once(std::string_view include_header,
                    unsigned long long& moves_out,
                    unsigned long long& final_unhappy_out,
                    std::string* build_log = nullptr);
+
+/**
+ * Compile (or reuse) the specialization and run `jobs` independent processes
+ * in it with sim::run_jobs_hitting_time: job j is seeded with
+ * core::job_seed(core::batch_key(Xoshiro256ss(master_seed)), j), so results
+ * match a statically compiled run_jobs_hitting_time with the same master
+ * RNG.
+ *
+ * @param master_seed      Seed of the batch's master RNG.
+ * @param jobs             Number of jobs (0 -> 1).
+ * @param threads          TBB arena size (0 -> TBB default).
+ * @param max_steps        Step budget per job (JobConfig::max_steps);
+ *                         UINT64_MAX for none.
+ * @param time_limit       Wall-clock budget of the batch in seconds, counted
+ *                         once the library is loaded (<= 0: none). Running
+ *                         jobs are cut off at it, unstarted ones skipped.
+ * @param times_out        Output: resized to the job count; entry j is job
+ *                         j's hitting time, or UINT64_MAX if it was censored
+ *                         by max_steps, cut off or never started.
+ * Other parameters and the return value are as for run_graph_once().
+ */
+int run_graph_batch(std::string_view include_header,
+                    std::string_view graph_type_expr,
+                    std::uint64_t p,
+                    std::uint64_t q,
+                    double density,
+                    std::uint64_t max_size_hint,
+                    std::uint64_t master_seed,
+                    std::size_t jobs,
+                    int threads,
+                    std::uint64_t max_steps,
+                    double time_limit,
+                    std::vector<std::uint64_t>& times_out,
+                    std::string* build_log = nullptr);
+
+// One specialization to precompile. max_size_hint must be the one later
+// calls pass (it selects CORE_INDEX_T and so the cache key).
+struct WarmupEntry {
+    std::string   include_header;
+    std::string   graph_type_expr;
+    std::uint64_t max_size_hint{0};
+};
+
+struct WarmupResult {
+    int         status{0};       // 0, or an error code (2, 3)
+    bool        cached{false};   // already built; nothing compiled
+    double      seconds{0.0};    // wall time for this entry
+    std::string log;             // compiler command, or "cached <path>"
+};
+
+// The entry run_lollipop_once/run_lollipop_batch use for these sizes.
+WarmupEntry lollipop_entry(std::size_t clique_size, std::size_t path_length);
+
+/**
+ * Fill the `_jit/` cache for every entry without loading anything: source
+ * generation, hashing and compiles run on `parallel` threads (0 -> hardware
+ * threads), so at most that many compiler processes run at once. Results
+ * are in entry order. Later calls for these specializations only dlopen.
+ */
+std::vector<WarmupResult> warmup(const std::vector<WarmupEntry>& entries, unsigned parallel = 0);
+
+} // namespace jit
@@ -0,0 +1,158 @@
+// checkpoint.hpp — save/resume a single long Schelling run
+//
+// File layout (native endianness, 8-byte aligned):
+//   CheckpointHeader | Graph::state_words words of graph state
+// The graph state is the graphs' own raw words (PaddedBitset words, clique
+// counts, bridge flags; see Checkpointable), so saving is one copy of the
+// bitset bytes and loading streams them back from an mmap'd file in a single
+// pass. Saves go through io::atomic_write_file (temp file, fsync, rename,
+// directory fsync), so a crash or power loss mid-save leaves the previous
+// checkpoint intact.
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "core/rng.hpp"
+#include "core/schelling_threshold.hpp"
+#include "io/atomic_file.hpp"
+#include "sim/graph_concepts.hpp"
+#include "sim/sim.hpp"
+
+namespace sim {
+
+struct CheckpointHeader {
+    static constexpr std::array<char, 8> magic_value{'S', 'C', 'H', 'L', 'C', 'K', 'P', 'T'};
+    static constexpr std::uint32_t version_value = 1;
+
+    std::array<char, 8> magic{magic_value};
+    std::uint32_t version{version_value};
+    std::uint32_t header_bytes{sizeof(CheckpointHeader)};
+    std::uint64_t total_size{0};    // Graph::TotalSize
+    std::uint64_t state_words{0};   // Graph::state_words
+    std::uint64_t tau_p{0}, tau_q{0};
+    std::uint64_t steps{0};         // hitting_time at the save point
+    std::array<std::uint64_t, 4> rng{};
+};
+static_assert(sizeof(CheckpointHeader) % 8 == 0);
+
+struct CheckpointConfig {
+    std::filesystem::path file;
+    std::chrono::duration<double> interval{600.0};   // wall clock between saves
+};
+
+// Write graph, rng and step counter to `file` (atomically replaced).
+template <class Graph>
+    requires Checkpointable<Graph>
+inline void save_checkpoint(const std::filesystem::path& file, const Graph& graph,
+                            const core::Xoshiro256ss& rng, std::uint64_t steps) {
+    CheckpointHeader h;
+    h.total_size  = Graph::TotalSize;
+    h.state_words = Graph::state_words;
+    h.tau_p = core::schelling::current_threshold().p;
+    h.tau_q = core::schelling::current_threshold().q;
+    h.steps = steps;
+    for (int i = 0; i < 4; ++i) h.rng[i] = rng.impl.s[i];
+
+    std::vector<std::uint64_t> state(Graph::state_words);
+    graph.save_state(state.data());
+
+    io::atomic_write_file(file, [&](std::ostream& out) {
+        out.write(reinterpret_cast<const char*>(&h), sizeof h);
+        out.write(reinterpret_cast<const char*>(state.data()),
+                  static_cast<std::streamsize>(state.size() * sizeof(std::uint64_t)));
+    });
+}
+
+// Restore graph and rng from `file`; returns the saved step counter. The
+// file must come from the same graph type and threshold.
+template <class Graph>
+    requires Checkpointable<Graph>
+inline std::uint64_t load_checkpoint(const std::filesystem::path& file, Graph& graph, core::Xoshiro256ss& rng) {
+    const int fd = ::open(file.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("load_checkpoint: cannot open " + file.string());
+    struct stat st{};
+    const std::size_t bytes = sizeof(CheckpointHeader) + Graph::state_words * sizeof(std::uint64_t);
+    if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) != bytes) {
+        ::close(fd);
+        throw std::runtime_error("load_checkpoint: " + file.string() + " has the wrong size for this graph");
+    }
+    void* map = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) throw std::runtime_error("load_checkpoint: cannot map " + file.string());
+
+    CheckpointHeader h;
+    std::memcpy(&h, map, sizeof h);
+    const char* error = nullptr;
+    if (h.magic != CheckpointHeader::magic_value || h.version != CheckpointHeader::version_value
+        || h.header_bytes != sizeof(CheckpointHeader))
+        error = "not a checkpoint of this format version";
+    else if (h.total_size != Graph::TotalSize || h.state_words != Graph::state_words)
+        error = "saved from a different graph type";
+    else if (h.tau_p != core::schelling::current_threshold().p || h.tau_q != core::schelling::current_threshold().q)
+        error = "saved under a different threshold";
+    if (error) {
+        ::munmap(map, bytes);
+        throw std::runtime_error("load_checkpoint: " + file.string() + " " + error);
+    }
+
+    ::madvise(map, bytes, MADV_SEQUENTIAL);
+    graph.load_state(reinterpret_cast<const std::uint64_t*>(static_cast<const char*>(map) + sizeof(CheckpointHeader)));
+    for (int i = 0; i < 4; ++i) rng.impl.s[i] = h.rng[i];
+    ::munmap(map, bytes);
+    return h.steps;
+}
+
+// run_schelling_process_until with periodic checkpoints. With resume and an
+// existing cfg.file the run continues from it (skipping initialization);
+// otherwise it starts fresh. A checkpoint is also written when stop() fires,
+// so an interrupted run resumes where it left off. Once the run completes
+// (settled or censored) cfg.file is removed, so a later resume cannot pick
+// up a stale state. Same draws, and so the same result, as an uninterrupted
+// run from the same rng.
+template <class Graph, class Stop>
+    requires GraphLike<Graph, core::Xoshiro256ss> && Checkpointable<Graph> && std::predicate<Stop&>
+inline std::optional<RunResult> run_schelling_process_checkpointed(
+        Graph& graph, double density, core::Xoshiro256ss& rng, Minority minority,
+        const CheckpointConfig& cfg, bool resume, Stop&& stop,
+        std::uint64_t max_steps = std::numeric_limits<std::uint64_t>::max()) {
+    std::uint64_t steps = 0;
+    if (resume && std::filesystem::exists(cfg.file)) steps = load_checkpoint(cfg.file, graph, rng);
+    else initialize_graph(graph, density, rng, minority);
+
+    using clock = std::chrono::steady_clock;
+    const auto interval = std::chrono::duration_cast<clock::duration>(cfg.interval);
+    auto next_save = clock::now() + interval;
+    auto res = continue_schelling_process(graph, density, rng, steps, [&](std::uint64_t ht) {
+        const bool halt = stop();
+        const auto now = clock::now();
+        if (halt || now >= next_save) {
+            save_checkpoint(cfg.file, graph, rng, ht);
+            next_save = now + interval;
+        }
+        return halt;
+    }, max_steps);
+    if (res) {
+        std::error_code ec;
+        if (std::filesystem::remove(cfg.file, ec)) io::detail::fsync_dir(cfg.file.parent_path());
+    }
+    return res;
+}
+
+} // namespace sim
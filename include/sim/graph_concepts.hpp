@@ -2,6 +2,8 @@
 #pragma once
 
 #include <concepts>
+#include <cstdint>
+#include "core/bitset.hpp"
 #include "core/config.hpp"
 
 namespace sim {
@@ -27,4 +29,36 @@ concept GraphLike = requires(G& g, const G& cg, size_t idx, bool c, URBG& rng) {
     { g.pop_agent(idx) } -> std::convertible_to<bool>;
 };
 
+// Optional: graphs that can draw the length of a run of null moves (moves
+// that leave the state unchanged) and the next effective move in one shot.
+// sample_effective_move returns the number of null steps skipped, or
+// max() when no effective move exists.
+template <class G, class URBG>
+concept NullMoveSkipping = requires(const G& cg, URBG& rng, size_t& from, size_t& to) {
+    { cg.sample_effective_move(rng, from, to) } -> std::convertible_to<std::uint64_t>;
+};
+
+// Optional: graphs that can return to their default-constructed (empty)
+// state in place, without reallocation (see sim/graph_pool.hpp).
+template <class G>
+concept Resettable = requires(G& g) {
+    { g.reset() } -> std::same_as<void>;
+};
+
+// Optional: graphs that can load a whole configuration at once from
+// TotalSize-bit occupancy/color bitsets (1 = occupied / color 1).
+template <class G>
+concept BulkLoadable = requires(G& g, const core::bitset<G::TotalSize>& occ, const core::bitset<G::TotalSize>& col) {
+    { g.bulk_load(occ, col) } -> std::same_as<void>;
+};
+
+// Optional: graphs whose full state is state_words 64-bit words, copied out
+// and back without per-vertex work (see sim/checkpoint.hpp).
+template <class G>
+concept Checkpointable = requires(G& g, const G& cg, std::uint64_t* out, const std::uint64_t* in) {
+    { G::state_words } -> std::convertible_to<std::size_t>;
+    { cg.save_state(out) } -> std::same_as<void>;
+    { g.load_state(in) } -> std::same_as<void>;
+};
+
 } // namespace sim
@@ -0,0 +1,30 @@
+// graph_pool.hpp — per-worker, heap-resident graph reuse for job runners
+#pragma once
+
+#include <tbb/cache_aligned_allocator.h>
+#include <tbb/enumerable_thread_specific.h>
+
+#include "sim/graph_concepts.hpp"
+
+namespace sim {
+
+// One graph per TBB worker, constructed on first use in cache-aligned heap
+// storage (no large graphs on worker stacks, no false sharing between
+// neighbours). acquire() hands back the caller's graph reset to the empty
+// state, so consecutive jobs on a worker reuse warm pages.
+template <class Graph>
+    requires Resettable<Graph>
+class GraphPool {
+public:
+    Graph& acquire() {
+        bool exists = false;
+        Graph& g = slots_.local(exists);
+        if (exists) g.reset();
+        return g;
+    }
+
+private:
+    tbb::enumerable_thread_specific<Graph, tbb::cache_aligned_allocator<Graph>, tbb::ets_key_per_instance> slots_;
+};
+
+} // namespace sim
@@ -0,0 +1,90 @@
+// heatmap.hpp — fixed-memory step x unhappy-count heatmap accumulator
+//
+// Rows are log-bucketed step ranges (LogHistogram's bucket layout with
+// StepSubBits: exact below 2^StepSubBits, then 2^StepSubBits rows per
+// octave); columns are equal-width unhappy-count bins. The cell grid is
+// allocated once, so memory is the same for a 10-step and a 10^12-step run,
+// and a null-move run of any length is added in O(rows it spans).
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/config.hpp"
+#include "sim/hitting_stats.hpp"
+#include "sim/step_dense.hpp"
+
+namespace sim {
+
+template <unsigned StepSubBits = 3>
+class StepHeatmap {
+public:
+    using step_axis = LogHistogram<StepSubBits>;
+    static constexpr std::size_t step_rows = step_axis::bucket_count;
+
+    // Unhappy counts 0..total_size in at most max_unhappy_bins columns.
+    explicit StepHeatmap(std::size_t total_size, std::size_t max_unhappy_bins = 256)
+        : width_((total_size + std::max<std::size_t>(max_unhappy_bins, 1)) / std::max<std::size_t>(max_unhappy_bins, 1)),
+          bins_(total_size / width_ + 1),
+          cells_(step_rows * bins_, 0) {}
+
+    std::size_t unhappy_bins()  const noexcept { return bins_; }
+    std::size_t unhappy_width() const noexcept { return width_; }
+
+    // Observer hook (see sim::NoObserve): states t0 .. t0+n-1 had `unhappy`.
+    void operator()(std::uint64_t t0, std::uint64_t n, core::count_t unhappy) noexcept { add(t0, n, unhappy); }
+
+    void add(std::uint64_t t0, std::uint64_t n, core::count_t unhappy) noexcept {
+        const std::size_t col = std::min<std::size_t>(static_cast<std::size_t>(unhappy) / width_, bins_ - 1);
+        while (n) {
+            const std::size_t row = step_axis::bucket_of(t0);
+            const std::uint64_t room = step_axis::bucket_high(row) - t0 + 1;   // 0 only past 2^64
+            const std::uint64_t take = (room == 0 || room > n) ? n : room;
+            cells_[row * bins_ + col] += take;
+            rows_used_ = std::max(rows_used_, row + 1);
+            if (take == n) break;
+            t0 += take;
+            n  -= take;
+        }
+    }
+
+    void merge(const StepHeatmap& o) noexcept {
+        for (std::size_t i = 0; i < o.rows_used_ * bins_; ++i) cells_[i] += o.cells_[i];
+        rows_used_ = std::max(rows_used_, o.rows_used_);
+    }
+
+    std::uint64_t cell(std::size_t row, std::size_t col) const noexcept { return cells_[row * bins_ + col]; }
+    std::size_t   rows() const noexcept { return rows_used_; }
+
+    // Dense rows x bins view for io::write_heatmap_ppm. Rows span different
+    // step counts; per_step scales each to the widest emitted row (counts
+    // per step, up to a common factor) so rows are comparable.
+    Heatmap to_heatmap(bool per_step = true) const {
+        Heatmap out;
+        out.bins = bins_;
+        out.rows = rows_used_;
+        out.data.assign(out.rows * out.bins, 0);
+        const double widest = rows_used_ ? row_steps_(rows_used_ - 1) : 1.0;
+        for (std::size_t r = 0; r < rows_used_; ++r) {
+            const double scale = per_step ? widest / row_steps_(r) : 1.0;
+            for (std::size_t c = 0; c < bins_; ++c)
+                out.data[r * bins_ + c] = static_cast<std::uint64_t>(std::llround(static_cast<double>(cell(r, c)) * scale));
+        }
+        return out;
+    }
+
+private:
+    static double row_steps_(std::size_t r) noexcept {
+        return static_cast<double>(step_axis::bucket_high(r) - step_axis::bucket_low(r)) + 1.0;
+    }
+
+    std::size_t width_;
+    std::size_t bins_;
+    std::size_t rows_used_{0};
+    std::vector<std::uint64_t> cells_;
+};
+
+} // namespace sim
@@ -0,0 +1,246 @@
+// hitting_stats.hpp — log-bucketed hitting-time histogram with streaming moments
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <optional>
+#include <ostream>
+
+namespace sim {
+
+// HDR-style histogram over uint64 values: values below 2^SubBits get exact
+// buckets, every power-of-two range above is split into 2^SubBits linear
+// sub-buckets, so a bucket spans at most 2^-SubBits of its values (0.8% at
+// the default). Fixed-size storage: record() never allocates.
+//
+// Moments come from exact 128-bit sums of v and v^2 (mean/variance are
+// derived on query, centered so there is no cancellation), so merge() is
+// integer addition: any split/join tree, thread count or sharding of the
+// same values yields a bit-identical histogram. Exact while sum(v^2) < 2^128.
+__extension__ using wide_uint = unsigned __int128;
+
+template <unsigned SubBits = 7>
+class LogHistogram {
+    static_assert(SubBits >= 1 && SubBits < 32, "LogHistogram: SubBits out of range");
+
+public:
+    static constexpr std::uint64_t sub_count    = std::uint64_t{1} << SubBits;
+    static constexpr std::size_t   bucket_count = static_cast<std::size_t>((65 - SubBits) * sub_count);
+
+    static constexpr std::size_t bucket_of(std::uint64_t v) noexcept {
+        if (v < sub_count) return static_cast<std::size_t>(v);
+        const unsigned e = 63u - static_cast<unsigned>(std::countl_zero(v));   // e >= SubBits
+        const unsigned shift = e - SubBits;
+        return static_cast<std::size_t>((e - SubBits + 1) * sub_count + ((v >> shift) & (sub_count - 1)));
+    }
+
+    // Smallest / largest value mapped to bucket i.
+    static constexpr std::uint64_t bucket_low(std::size_t i) noexcept {
+        if (i < sub_count) return i;
+        const unsigned shift = static_cast<unsigned>(i / sub_count) - 1u;
+        return (sub_count + (i & (sub_count - 1))) << shift;
+    }
+    static constexpr std::uint64_t bucket_high(std::size_t i) noexcept {
+        if (i < sub_count) return i;
+        const unsigned shift = static_cast<unsigned>(i / sub_count) - 1u;
+        return bucket_low(i) + ((std::uint64_t{1} << shift) - 1);
+    }
+
+    void record(std::uint64_t v) noexcept {
+        ++counts_[bucket_of(v)];
+        ++n_;
+        sum_    += v;
+        sum_sq_ += wide_uint{v} * v;
+        min_ = std::min(min_, v);
+        max_ = std::max(max_, v);
+    }
+
+    void merge(const LogHistogram& o) noexcept {
+        if (o.n_ == 0) return;
+        for (std::size_t i = 0; i < bucket_count; ++i) counts_[i] += o.counts_[i];
+        n_      += o.n_;
+        sum_    += o.sum_;
+        sum_sq_ += o.sum_sq_;
+        min_ = std::min(min_, o.min_);
+        max_ = std::max(max_, o.max_);
+    }
+
+    std::uint64_t count()     const noexcept { return n_; }
+    wide_uint     sum()       const noexcept { return sum_; }
+    std::uint64_t min()       const noexcept { return n_ ? min_ : 0; }
+    std::uint64_t max()       const noexcept { return max_; }
+    double mean() const noexcept {
+        return n_ ? static_cast<double>(static_cast<long double>(sum_) / static_cast<long double>(n_)) : 0.0;
+    }
+    // Sum of squared deviations: with q = floor(mean), r = sum mod n,
+    //   sum (v - mean)^2 = [sum v^2 - 2 q sum v + n q^2] - r^2 / n,
+    // where the bracket is exact in wrapping 128-bit arithmetic.
+    double variance() const noexcept {
+        if (n_ < 2) return 0.0;
+        const wide_uint q = sum_ / n_, r = sum_ % n_;
+        const wide_uint d = sum_sq_ - 2 * q * sum_ + wide_uint{n_} * q * q;
+        const long double m2 = static_cast<long double>(d) - static_cast<long double>(r) * static_cast<long double>(r) / static_cast<long double>(n_);
+        return static_cast<double>(m2 / static_cast<long double>(n_ - 1));
+    }
+    double stddev()   const noexcept { return std::sqrt(variance()); }
+
+    // Value at quantile q in [0,1]: the top of the bucket holding the
+    // ceil(q*n)-th smallest value, clamped to the observed [min, max].
+    std::uint64_t quantile(double q) const noexcept {
+        if (n_ == 0) return 0;
+        q = std::clamp(q, 0.0, 1.0);
+        const std::uint64_t rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(n_))));
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < bucket_count; ++i) {
+            seen += counts_[i];
+            if (seen >= rank) return std::clamp(bucket_high(i), min_, max_);
+        }
+        return max_;
+    }
+
+    std::uint64_t bucket(std::size_t i) const noexcept { return counts_[i]; }
+
+    // Binary form: scalars, then the non-empty buckets as (index, count).
+    // Field by field (no padding bytes), so equal histograms write equal bytes.
+    void write(std::ostream& out) const {
+        std::uint64_t nonempty = 0;
+        for (auto c : counts_) nonempty += c != 0;
+        const std::uint64_t head[] = { SubBits, n_, min_, max_,
+                                       static_cast<std::uint64_t>(sum_), static_cast<std::uint64_t>(sum_ >> 64),
+                                       static_cast<std::uint64_t>(sum_sq_), static_cast<std::uint64_t>(sum_sq_ >> 64),
+                                       nonempty };
+        out.write(reinterpret_cast<const char*>(head), sizeof head);
+        for (std::size_t i = 0; i < bucket_count; ++i) {
+            if (!counts_[i]) continue;
+            const std::uint64_t pair[] = { i, counts_[i] };
+            out.write(reinterpret_cast<const char*>(pair), sizeof pair);
+        }
+    }
+
+    // Inverse of write(); false (histogram unspecified) on a short or foreign stream.
+    bool read(std::istream& in) {
+        std::uint64_t head[9];
+        if (!in.read(reinterpret_cast<char*>(head), sizeof head) || head[0] != SubBits) return false;
+        *this = LogHistogram{};
+        n_ = head[1]; min_ = head[2]; max_ = head[3];
+        sum_    = (wide_uint{head[5]} << 64) | head[4];
+        sum_sq_ = (wide_uint{head[7]} << 64) | head[6];
+        for (std::uint64_t k = 0; k < head[8]; ++k) {
+            std::uint64_t pair[2];
+            if (!in.read(reinterpret_cast<char*>(pair), sizeof pair) || pair[0] >= bucket_count) return false;
+            counts_[pair[0]] = pair[1];
+        }
+        return true;
+    }
+
+private:
+    std::array<std::uint64_t, bucket_count> counts_{};
+    std::uint64_t n_{0};
+    std::uint64_t min_{std::numeric_limits<std::uint64_t>::max()}, max_{0};
+    wide_uint     sum_{0}, sum_sq_{0};
+};
+
+// Hitting-time distribution of a batch with right-censoring. Settled runs
+// go to settled(); runs cut off by a step budget (or that can never settle),
+// or abandoned in flight by a cancel or deadline, go to censored() at the
+// step count they reached. Moments and quantiles of
+// settled() are conditional on settling; survival()/km_quantile() give the
+// Kaplan-Meier estimate over both, at bucket resolution.
+class HittingTimeStats {
+public:
+    using histogram = LogHistogram<>;
+
+    void record(std::uint64_t t) noexcept { settled_.record(t); }
+    void record_censored(std::uint64_t t, std::uint64_t unhappy) noexcept {
+        censored_.record(t);
+        censored_unhappy_ += unhappy;
+    }
+    // A run abandoned by a cancel/deadline: censored at step t, and counted
+    // in interrupted_count() (in memory only; not part of write()/read()).
+    void record_interrupted(std::uint64_t t, std::uint64_t unhappy) noexcept {
+        record_censored(t, unhappy);
+        ++interrupted_;
+    }
+
+    void merge(const HittingTimeStats& o) noexcept {
+        settled_.merge(o.settled_);
+        censored_.merge(o.censored_);
+        censored_unhappy_ += o.censored_unhappy_;
+        interrupted_ += o.interrupted_;
+    }
+
+    void write(std::ostream& out) const {
+        settled_.write(out);
+        censored_.write(out);
+        out.write(reinterpret_cast<const char*>(&censored_unhappy_), sizeof censored_unhappy_);
+    }
+    bool read(std::istream& in) {
+        return settled_.read(in) && censored_.read(in)
+            && static_cast<bool>(in.read(reinterpret_cast<char*>(&censored_unhappy_), sizeof censored_unhappy_));
+    }
+
+    const histogram& settled()  const noexcept { return settled_; }
+    const histogram& censored() const noexcept { return censored_; }
+    std::uint64_t count()          const noexcept { return settled_.count() + censored_.count(); }
+    std::uint64_t censored_count() const noexcept { return censored_.count(); }
+    // Censored runs that a cancel/deadline cut off rather than a step budget.
+    std::uint64_t interrupted_count() const noexcept { return interrupted_; }
+
+    // Mean unhappy_count left behind by censored runs.
+    double mean_censored_unhappy() const noexcept {
+        return censored_.count() ? static_cast<double>(censored_unhappy_) / static_cast<double>(censored_.count()) : 0.0;
+    }
+
+    // Kaplan-Meier P(T > t), evaluated at the top of t's bucket. Censorings
+    // in a bucket leave the risk set after that bucket's events.
+    double survival(std::uint64_t t) const noexcept {
+        const std::size_t last = histogram::bucket_of(t);
+        double s = 1.0;
+        std::uint64_t at_risk = count();
+        for (std::size_t i = 0; i <= last && at_risk; ++i) {
+            const std::uint64_t d = settled_.bucket(i);
+            if (d) s *= 1.0 - static_cast<double>(d) / static_cast<double>(at_risk);
+            at_risk -= d + censored_.bucket(i);
+        }
+        return s;
+    }
+
+    // Smallest bucket top where the KM survival drops to 1-q or below;
+    // nullopt if censoring leaves the q-quantile undetermined.
+    std::optional<std::uint64_t> km_quantile(double q) const noexcept {
+        if (settled_.count() == 0) return std::nullopt;
+        const double target = 1.0 - std::clamp(q, 0.0, 1.0) + 1e-12;   // absorb product round-off
+        double s = 1.0;
+        std::uint64_t at_risk = count();
+        for (std::size_t i = 0; i < histogram::bucket_count && at_risk; ++i) {
+            const std::uint64_t d = settled_.bucket(i);
+            if (d) s *= 1.0 - static_cast<double>(d) / static_cast<double>(at_risk);
+            if (s <= target) return std::clamp(histogram::bucket_high(i), settled_.min(), settled_.max());
+            at_risk -= d + censored_.bucket(i);
+        }
+        return std::nullopt;
+    }
+
+private:
+    histogram     settled_{};
+    histogram     censored_{};
+    std::uint64_t censored_unhappy_{0};
+    std::uint64_t interrupted_{0};
+};
+
+// Half-width of the normal z-interval on h's mean, relative to the mean
+// (z * s / sqrt(n) / mean); infinity until there are two values and a
+// non-zero mean.
+template <unsigned SubBits>
+inline double relative_ci_half_width(const LogHistogram<SubBits>& h, double z) noexcept {
+    if (h.count() < 2 || h.mean() <= 0.0) return std::numeric_limits<double>::infinity();
+    return z * h.stddev() / std::sqrt(static_cast<double>(h.count())) / h.mean();
+}
+
+} // namespace sim
@@ -2,27 +2,50 @@
 #pragma once
 
 #include <algorithm>
+#include <optional>
 #include <random>
 
 #include "core/bitset.hpp"
+#include "core/config.hpp"
+#include "core/random_bitset.hpp"
 #include "core/rng.hpp"
 #include "sim/graph_concepts.hpp"
 
 namespace sim {
 
+// Color-1 share of the initial agents. Empty means the default 1/2 with the
+// legacy coloring of initialize_graph_rejection (alternating in placement
+// order); any given share, 1/2 included, colors a uniform subset. Both give
+// the same law; the empty case keeps older configurations bit for bit.
+using Minority = std::optional<double>;
+
+inline double minority_share(Minority minority) noexcept { return minority.value_or(0.5); }
+
+// Number of color-1 (minority) agents among K: floor(K * minority), so the
+// default 1/2 keeps the legacy floor(K/2) of alternating placement.
+inline core::count_t minority_count(core::count_t K, double minority) noexcept {
+    if (!(minority > 0.0)) return 0;
+    if (minority >= 1.0) return K;
+    return static_cast<core::count_t>(static_cast<double>(K) * minority);
+}
+
 // Rejection-sampling initializer:
 // Picks uniform indices in [0, N) until exactly K = floor(density*N)
 // unique positions are chosen. Uses a local bitset to track picks and
-// alternates colors by placement order. Expected O(N) trials for
+// alternates colors by placement order (a given minority share colors the
+// first minority_count(K) placements instead). Expected O(N) trials for
 // constant density, no scans or auxiliary containers.
 template <class G, class URBG>
     requires GraphLike<G, URBG>
-inline void initialize_graph_rejection(G& graph, double density, URBG& rng) {
+inline void initialize_graph_rejection(G& graph, double density, URBG& rng, Minority minority = {}) {
     using count_t = core::count_t;
     using size_t  = core::size_t;
     const count_t N = static_cast<count_t>(G::TotalSize);
     const count_t K = static_cast<count_t>(static_cast<double>(N) * density);
 
+    const count_t M = minority_count(K, minority_share(minority));
+    const bool alternate = !minority.has_value();
+
     core::bitset<G::TotalSize> chosen; // all zeros
     count_t placed = 0;
     if (N == 0 || K == 0) return;
@@ -31,57 +54,80 @@ inline void initialize_graph_rejection(G& graph, double density, URBG& rng) {
         const std::size_t i = static_cast<std::size_t>(pick(rng));
         if (!chosen.test(i)) {
             chosen.set(i);
-            graph.place_agent(static_cast<size_t>(i), static_cast<bool>(placed & 1));
+            graph.place_agent(static_cast<size_t>(i), alternate ? static_cast<bool>(placed & 1) : (placed < M));
             ++placed;
         }
     }
 }
 
-// Construct a random occupancy bitstring of Hamming weight ~= density * N
-// using Floyd's algorithm to avoid scans. Returns a core::bitset<G::TotalSize>
-// with 1 = occupied, 0 = unoccupied.
+// Random occupancy bitstring of Hamming weight exactly K = floor(density * N),
+// built a word at a time (core/random_bitset.hpp). Returns a
+// core::bitset<G::TotalSize> with 1 = occupied, 0 = unoccupied; ~occ feeds
+// Path's (unoccupied, colors) constructor directly.
 template <class G, class URBG>
 inline core::bitset<G::TotalSize>
 make_random_occupancy_bitset(double density, URBG& rng) {
     using count_t = core::count_t;
     const count_t N = static_cast<count_t>(G::TotalSize);
     const count_t K = static_cast<count_t>(static_cast<double>(N) * density);
+    return core::random_weight_bitset<G::TotalSize>(N, K, rng);
+}
 
-    core::bitset<G::TotalSize> out; // all zeros
-    if (K == 0) return out;
-    if (K >= N) { out.set(); return out; }
+// Colors for the occupied set of `occ`: a uniform subset of
+// minority_count(K, minority) agents is color 1, drawn independently of the
+// occupancy. At minority = 1/2 this is the law of the per-agent initializers
+// (alternating colors in a uniform placement order).
+template <std::size_t N, class URBG>
+inline core::bitset<N> make_random_color_bitset(const core::bitset<N>& occ, URBG& rng, double minority = 0.5) {
+    const core::count_t K = static_cast<core::count_t>(occ.count());
+    return core::random_weight_bitset_within(occ, minority_count(K, minority), rng);
+}
 
-    for (count_t j = N - K; j < N; ++j) {
-        const std::uint64_t r = core::uniform_bounded(rng, static_cast<std::uint64_t>(j + 1));
-        const std::size_t t = static_cast<std::size_t>(r);
-        if (out.test(t)) out.set(static_cast<std::size_t>(j));
-        else             out.set(t);
-    }
-    return out;
+// Bulk initializer: occupancy and colors are built word-parallel, then
+// loaded in one bulk_load() call instead of K place_agent() mutations.
+template <class G, class URBG>
+    requires GraphLike<G, URBG> && BulkLoadable<G>
+inline void initialize_graph_bulk(G& graph, double density, URBG& rng, Minority minority = {}) {
+    const auto occ = make_random_occupancy_bitset<G>(density, rng);
+    const auto col = make_random_color_bitset(occ, rng, minority_share(minority));
+    graph.bulk_load(occ, col);
 }
 
-// Initialize a graph using the permuted-bitstring approach above. Colors
-// alternate deterministically with placement order to match legacy behavior.
+// Initialize a graph using the permuted-bitstring approach above, one
+// place_agent per agent: same occupancy and colors (and so the same law) as
+// initialize_graph_bulk, for graphs without bulk_load.
 template <class G, class URBG>
     requires GraphLike<G, URBG>
-inline void initialize_graph_permuted(G& graph, double density, URBG& rng) {
-    using count_t = core::count_t;
+inline void initialize_graph_permuted(G& graph, double density, URBG& rng, Minority minority = {}) {
     const auto occ = make_random_occupancy_bitset<G>(density, rng);
-    const count_t total = static_cast<count_t>(G::TotalSize);
-    count_t placed = 0;
-    for (count_t i = 0; i < total; ++i) {
-        if (occ.test(static_cast<std::size_t>(i))) {
-            graph.place_agent(static_cast<core::size_t>(i), static_cast<bool>(placed & 1));
-            ++placed;
-        }
+    const auto col = make_random_color_bitset(occ, rng, minority_share(minority));
+    for (std::size_t i = 0; i < G::TotalSize; ++i)
+        if (occ.test(i)) graph.place_agent(static_cast<core::size_t>(i), col.test(i));
+}
+
+// Default initializer: bulk load when the graph supports it, else rejection.
+template <class G, class URBG>
+    requires GraphLike<G, URBG>
+inline void initialize_graph(G& graph, double density, URBG& rng, Minority minority = {}) {
+    if constexpr (SCHELLING_BULK_INIT && BulkLoadable<G>) {
+        initialize_graph_bulk<G>(graph, density, rng, minority);
+    } else {
+        initialize_graph_rejection<G>(graph, density, rng, minority);
     }
 }
 
-// Default initializer delegating to rejection (current default)
+// Initializer for common random numbers: occupancy from occ_rng, colors from
+// col_rng, so the same pair of streams gives the same configuration at equal
+// density whatever else differs between runs.
 template <class G, class URBG>
     requires GraphLike<G, URBG>
-inline void initialize_graph(G& graph, double density, URBG& rng) {
-    initialize_graph_rejection<G>(graph, density, rng);
+inline void initialize_graph_streams(G& graph, double density, URBG& occ_rng, URBG& col_rng, Minority minority = {}) {
+    if constexpr (BulkLoadable<G>) {
+        const auto occ = make_random_occupancy_bitset<G>(density, occ_rng);
+        graph.bulk_load(occ, make_random_color_bitset(occ, col_rng, minority_share(minority)));
+    } else {
+        initialize_graph_rejection<G>(graph, density, occ_rng, minority);   // colors follow placement order
+    }
 }
 
 } // namespace sim
@@ -1,4 +1,4 @@
-// job_handler.hpp — streamed heatmap with OpenMP reduction (no histories, no locks)
+// job_handler.hpp — TBB batch runners: hitting-time distribution, step x unhappy heatmap
 #pragma once
 
 #include <cstddef>
@@ -7,57 +7,464 @@
 #include <atomic>
 #include <algorithm>
 #include <tbb/blocked_range.h>
-#include <tbb/parallel_reduce.h>
+#include <tbb/parallel_for.h>
+#include <tbb/partitioner.h>
+#include <tbb/task_arena.h>
+#include <tbb/task_group.h>
+#include <tbb/enumerable_thread_specific.h>
 #include <tbb/global_control.h>
+#include <chrono>
+#include <condition_variable>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <optional>
 
 #include "core/rng.hpp"
+#include "core/schelling_threshold.hpp"
 #include "sim/graph_concepts.hpp"
+#include "sim/graph_pool.hpp"
+#include "sim/heatmap.hpp"
+#include "sim/hitting_stats.hpp"
+#include "sim/placement.hpp"
+#include "sim/replica_path.hpp"
+#include "sim/shard.hpp"
 #include "sim/sim.hpp"
 #include "sim/step_dense.hpp"
 #include <memory>
 
 namespace sim {
 
+namespace trajectory { class Sink; }
+
 // ---------- Config ----------
 struct JobConfig {
     std::size_t jobs{100};      // 0 -> 1
     double      density{0.8};
+    Minority    minority{};     // color-1 share of the initial agents (empty: 1/2, see sim/init.hpp)
     int         threads{0};   // 0 -> tbb default
+    // Threshold of this batch's jobs, installed per task with ThresholdScope
+    // (empty: the workers' current threshold, normally program_threshold).
+    std::optional<core::schelling::PqThreshold> tau{};
+    // Step budget per job; runs still unsettled after it are censored.
+    std::uint64_t max_steps{std::numeric_limits<std::uint64_t>::max()};
+    // Cooperative stop: when the flag is raised or the deadline passes,
+    // running jobs are censored where they stand (see detail::run_job) and
+    // unstarted ones are dropped.
+    const std::atomic<bool>*              cancel{nullptr};
+    std::chrono::steady_clock::time_point deadline{std::chrono::steady_clock::time_point::max()};
+    // Run only this shard's job indices (see sim/shard.hpp); seeds are unchanged.
+    ShardSpec   shard{};
+    // Sequential stopping (run_jobs_hitting_time_sequential): `jobs` is the cap;
+    // stop at the first multiple of `wave` completed jobs where the relative
+    // half-width of the ci_z confidence interval on the mean is <= ci_target.
+    double      ci_target{0.0};
+    double      ci_z{1.96};
+    std::size_t wave{32};
+    // Worker pinning / per-NUMA-node arenas for run_jobs_hitting_time (see
+    // sim/placement.hpp); default: one unpinned arena.
+    PlacementPolicy placement{};
+    // Record the moves of these job indices (sorted) into *trajectories; needs
+    // a build with SCHELLING_RECORD_TRAJECTORIES=1 (see sim/trajectory.hpp).
+    trajectory::Sink*        trajectories{nullptr};
+    std::vector<std::size_t> record_jobs{};
+    // run_sweep: job j of every point uses job j's seed, split into
+    // initialization and dynamics streams (common random numbers).
+    bool        common_random_numbers{false};
+};
+
+// Stop predicate shared by a batch's tasks. The first task that sees the
+// cancel flag or the deadline cancels the TBB group: unstarted jobs are
+// skipped and running ones abandon at their next poll.
+class BatchStop {
+public:
+    BatchStop(const JobConfig& cfg, tbb::task_group_context& ctx) noexcept
+        : cancel_(cfg.cancel), deadline_(cfg.deadline), ctx_(ctx) {}
+
+    bool operator()() const noexcept {
+        if (ctx_.is_group_execution_cancelled()) return true;
+        const bool flagged = cancel_ && cancel_->load(std::memory_order_relaxed);
+        const bool late = deadline_ != std::chrono::steady_clock::time_point::max()
+                       && std::chrono::steady_clock::now() >= deadline_;
+        if (flagged || late) [[unlikely]] { ctx_.cancel_group_execution(); return true; }
+        return false;
+    }
+
+private:
+    const std::atomic<bool>*              cancel_;
+    std::chrono::steady_clock::time_point deadline_;
+    tbb::task_group_context&              ctx_;
 };
 
-// Result types and helpers moved to sim/step_dense.hpp and sim/reductions.hpp
+// Heatmap types and helpers live in sim/step_dense.hpp and sim/heatmap.hpp
+
+// A job's entry in a per-job `times` vector: settled hitting time, or this.
+inline constexpr std::uint64_t no_hitting_time = std::numeric_limits<std::uint64_t>::max();
+
+// ---------- Per-worker accumulation ----------
+// Each worker owns a fixed-size HittingTimeStats (enumerable_thread_specific)
+// merged once after the loop, so the per-job path is a bucket increment.
+// Not parallel_reduce: after a cancel it skips Body::join, which would drop
+// the finished jobs of every split body.
+namespace detail {
+
+inline void record_run(HittingTimeStats& stats, const RunResult& r) noexcept {
+    if (r.censored) stats.record_censored(r.steps, r.unhappy);
+    else            stats.record(r.steps);
+}
+
+// Records job j's moves while in scope if cfg selects it; empty unless built
+// with SCHELLING_RECORD_TRAJECTORIES.
+class JobRecording {
+public:
+    JobRecording([[maybe_unused]] const JobConfig& cfg, [[maybe_unused]] std::size_t j) {
+#if SCHELLING_RECORD_TRAJECTORIES
+        if (cfg.trajectories && std::binary_search(cfg.record_jobs.begin(), cfg.record_jobs.end(), j)) {
+            rec_.emplace(*cfg.trajectories, j);
+            scope_.emplace(*rec_);
+        }
+#endif
+    }
+
+#if SCHELLING_RECORD_TRAJECTORIES
+private:
+    std::optional<trajectory::Recorder> rec_;
+    std::optional<trajectory::Scope>    scope_;
+#endif
+};
+
+// Job j of a batch on g, recorded into `stats` (and its settled time into
+// `times`). A run that stop() abandons in flight is recorded as censored at
+// the step it reached (record_interrupted): dropping it would bias the
+// distribution toward short runs, the ones that finish before a deadline.
+template <class Graph, class Stop, class Observe = NoObserve>
+inline void run_job(Graph& g, const JobConfig& cfg, std::uint64_t key, std::size_t j, const Stop& stop,
+                    HittingTimeStats& stats, std::vector<std::uint64_t>* times = nullptr,
+                    Observe&& observe = Observe{}) {
+    core::Xoshiro256ss rng(core::job_seed(key, j));
+    const core::schelling::ThresholdScope tau(cfg.tau ? *cfg.tau : core::schelling::current_threshold());
+    const JobRecording recording(cfg, j);
+    std::uint64_t reached = 0;
+    const auto res = sim::run_schelling_process_until(g, cfg.density, rng, cfg.minority,
+                                                      [&](std::uint64_t steps) { reached = steps; return stop(); },
+                                                      cfg.max_steps, std::forward<Observe>(observe));
+    if (!res) { stats.record_interrupted(reached, g.unhappy_count()); return; }
+    record_run(stats, *res);
+    if (times && !res->censored) (*times)[j] = res->steps;
+}
+
+// run_jobs_hitting_time under a PlacementPolicy: one pinned arena per domain,
+// all running concurrently and pulling job indices from one ticket counter
+// (per-job dynamic balancing, also across nodes). Each domain has its own
+// graph pool and per-worker stats, built by the pinned workers themselves.
+template <class Graph>
+inline HittingTimeStats run_placed_hitting_time(const JobConfig& cfg, std::uint64_t key,
+                                                std::size_t first, std::size_t last,
+                                                std::vector<std::uint64_t>* times) {
+    struct Site {
+        tbb::task_arena                                 arena;
+        PinningObserver                                 pin;
+        GraphPool<Graph>                                pool;
+        tbb::enumerable_thread_specific<HittingTimeStats> stats;
+        tbb::task_group                                 group;
+        int                                             threads;
+        // No slot reserved for a master: the caller only joins the arena it
+        // waits on, so a reserved slot would leave every other domain a
+        // thread short (and a 1-thread domain idle) until then.
+        explicit Site(const Domain& d) : arena(d.threads, 0), pin(arena, d.cpus), threads(d.threads) {}
+    };
+
+    tbb::task_group_context ctx;
+    const BatchStop stop(cfg, ctx);
+    std::atomic<std::size_t> next{first};
+    std::vector<std::unique_ptr<Site>> sites;
+    for (const Domain& d : make_domains(cfg.placement, cfg.threads)) sites.push_back(std::make_unique<Site>(d));
+
+    for (auto& site : sites) {
+        Site& s = *site;
+        s.arena.execute([&] {
+            s.group.run([&] {
+                tbb::parallel_for(0, s.threads, [&](int) {
+                    HittingTimeStats& local = s.stats.local();
+                    for (std::size_t j; !stop() && (j = next.fetch_add(1, std::memory_order_relaxed)) < last;)
+                        run_job(s.pool.acquire(), cfg, key, j, stop, local, times);
+                });
+            });
+        });
+    }
+    HittingTimeStats out;
+    for (auto& site : sites) {
+        Site& s = *site;
+        s.arena.execute([&] { s.group.wait(); });
+        s.stats.combine_each([&](const HittingTimeStats& st) { out.merge(st); });
+    }
+    return out;
+}
+
+} // namespace detail
 
 // ---------- Parallel hitting-time runner (no heatmap) ----------
-// Runs J independent experiments in parallel and returns the total steps
-// (hitting time measured as number of moves to reach zero-unhappy), leaving
-// aggregation/averaging to the caller. This keeps the OpenMP parallel loop
-// but eliminates any StepDense/heatmap work.
+// Runs J independent experiments in parallel and returns their hitting-time
+// distribution (moves to reach zero-unhappy): log-bucketed histogram, exact
+// sum/min/max and mean/variance. Runs that exhaust cfg.max_steps
+// or can never settle are recorded as censored (see HittingTimeStats).
+//
+// Every job is its own task (grainsize 1, simple_partitioner), so idle
+// workers steal single jobs and a heavy-tailed run never holds a queue of
+// others behind it. Runs inside a task_arena of cfg.threads workers. At
+// cfg.cancel/cfg.deadline, jobs in flight are recorded as censored at the
+// step they reached (stats.interrupted_count() of them) and jobs not yet
+// started are missing: J - stats.count() of them, an unbiased subset. With
+// cfg.shard only that shard's jobs run.
+// With cfg.placement, workers are pinned and split into per-node arenas;
+// the distribution is the same (stats merge exactly in any order).
+// If `times` is given it receives J entries: job j's settled hitting time,
+// no_hitting_time for censored, dropped or other shards' jobs.
+template <class Graph, class SeedRng>
+    requires GraphLike<Graph, SeedRng> && Resettable<Graph>
+inline HittingTimeStats
+run_jobs_hitting_time(const JobConfig& cfg_in, SeedRng& master_rng, std::vector<std::uint64_t>* times = nullptr) {
+    const std::size_t J = (cfg_in.jobs == 0) ? 1 : cfg_in.jobs;
+    const int NT        = (cfg_in.threads > 0) ? cfg_in.threads : tbb::this_task_arena::max_concurrency();
+
+    // Counter-based per-job seeds: job j is seeded inside its task from (key, j)
+    const std::uint64_t key = core::batch_key(master_rng);
+    if (times) times->assign(J, no_hitting_time);
+    if (cfg_in.placement.enabled())
+        return detail::run_placed_hitting_time<Graph>(cfg_in, key, cfg_in.shard.begin(J), cfg_in.shard.end(J), times);
+
+    // Per-worker graphs: heap-resident, reset between jobs
+    GraphPool<Graph> pool;
+    tbb::enumerable_thread_specific<HittingTimeStats> acc;
+
+    tbb::task_group_context ctx;
+    const BatchStop stop(cfg_in, ctx);
+    tbb::task_arena arena(NT);
+    arena.execute([&] {
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(cfg_in.shard.begin(J), cfg_in.shard.end(J), 1),
+                          [&](const tbb::blocked_range<std::size_t>& r) {
+            HittingTimeStats& local = acc.local();
+            for (std::size_t j = r.begin(); j != r.end(); ++j) {
+                if (stop()) return;
+                detail::run_job(pool.acquire(), cfg_in, key, j, stop, local, times);
+            }
+        }, tbb::simple_partitioner{}, ctx);
+    });
+    HittingTimeStats out;
+    acc.combine_each([&](const HittingTimeStats& st) { out.merge(st); });
+    return out;
+}
+
+// ---------- Heatmap runner ----------
+struct HeatmapResult {
+    HittingTimeStats stats{};
+    StepHeatmap<>    heatmap;
+};
+
+// run_jobs_hitting_time that also accumulates every run's step x
+// unhappy_count trajectory into a StepHeatmap (fixed memory, see
+// sim/heatmap.hpp). Each worker owns one accumulator; they are merged once
+// after the loop. Runs cut off in flight by cancellation/deadline leave
+// their partial trajectories in the heatmap and are censored in stats.
 template <class Graph, class SeedRng>
-    requires GraphLike<Graph, SeedRng>
-inline size_t
-run_jobs_hitting_time(const JobConfig& cfg_in, SeedRng& master_rng) {
+    requires GraphLike<Graph, SeedRng> && Resettable<Graph>
+inline HeatmapResult
+run_jobs_heatmap(const JobConfig& cfg_in, SeedRng& master_rng, std::size_t max_unhappy_bins = 256) {
     const std::size_t J = (cfg_in.jobs == 0) ? 1 : cfg_in.jobs;
     const int NT        = (cfg_in.threads > 0) ? cfg_in.threads : tbb::this_task_arena::max_concurrency();
+    const std::uint64_t key = core::batch_key(master_rng);
+
+    GraphPool<Graph> pool;
+    tbb::enumerable_thread_specific<HeatmapResult> acc([&] {
+        return HeatmapResult{ {}, StepHeatmap<>(Graph::TotalSize, max_unhappy_bins) };
+    });
+    tbb::task_group_context ctx;
+    const BatchStop stop(cfg_in, ctx);
+    tbb::task_arena arena(NT);
+    arena.execute([&] {
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(cfg_in.shard.begin(J), cfg_in.shard.end(J), 1),
+                          [&](const tbb::blocked_range<std::size_t>& r) {
+            HeatmapResult& local = acc.local();
+            for (std::size_t j = r.begin(); j != r.end(); ++j) {
+                if (stop()) return;
+                detail::run_job(pool.acquire(), cfg_in, key, j, stop, local.stats, nullptr, local.heatmap);
+            }
+        }, tbb::simple_partitioner{}, ctx);
+    });
 
-    // Deterministic per-job seeds (no RNG races)
-    std::vector<std::uint64_t> seeds(J);
-    for (std::size_t i = 0; i < J; ++i) seeds[i] = core::splitmix_hash(master_rng());
+    HeatmapResult out{ {}, StepHeatmap<>(Graph::TotalSize, max_unhappy_bins) };
+    acc.combine_each([&](const HeatmapResult& h) { out.stats.merge(h.stats); out.heatmap.merge(h.heatmap); });
+    return out;
+}
+
+// ---------- Exact per-step heatmap runner ----------
+struct StepDenseResult {
+    HittingTimeStats stats{};
+    Heatmap          heatmap{};   // one row per step
+};
 
-    auto total = tbb::parallel_reduce(
-        tbb::blocked_range<std::size_t>(0, J),
-        std::uint64_t{0},
-        [&](const tbb::blocked_range<std::size_t>& r, std::uint64_t init) {
+// Like run_jobs_heatmap, but with one row per step (StepDense); unhappy
+// counts go to at most max_unhappy_bins equal-width columns. Memory grows
+// with the longest run (rows x bins counters per worker), so bound it with
+// cfg.max_steps. Per-worker arenas are tree-reduced in parallel and handed
+// to the Heatmap uncopied.
+template <class Graph, class SeedRng>
+    requires GraphLike<Graph, SeedRng> && Resettable<Graph>
+inline StepDenseResult
+run_jobs_step_dense(const JobConfig& cfg_in, SeedRng& master_rng, std::size_t max_unhappy_bins = 256) {
+    const std::size_t J = (cfg_in.jobs == 0) ? 1 : cfg_in.jobs;
+    const int NT        = (cfg_in.threads > 0) ? cfg_in.threads : tbb::this_task_arena::max_concurrency();
+    const std::uint64_t key = core::batch_key(master_rng);
+    const std::size_t cap   = std::max<std::size_t>(max_unhappy_bins, 1);
+    const std::size_t width = (static_cast<std::size_t>(Graph::TotalSize) + cap) / cap;
+    const std::size_t bins  = static_cast<std::size_t>(Graph::TotalSize) / width + 1;
+
+    struct Local {
+        HittingTimeStats stats{};
+        StepDense        rows;
+    };
+    GraphPool<Graph> pool;
+    tbb::enumerable_thread_specific<Local> acc([&] { return Local{ {}, StepDense(bins, width) }; });
+    tbb::task_group_context ctx;
+    const BatchStop stop(cfg_in, ctx);
+    tbb::task_arena arena(NT);
+    StepDenseResult out;
+    arena.execute([&] {
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(cfg_in.shard.begin(J), cfg_in.shard.end(J), 1),
+                          [&](const tbb::blocked_range<std::size_t>& r) {
+            Local& local = acc.local();
             for (std::size_t j = r.begin(); j != r.end(); ++j) {
-                core::Xoshiro256ss rng(seeds[j]);
-                Graph g;
-                init += static_cast<std::uint64_t>(
-                    sim::run_schelling_process(g, cfg_in.density, rng));
+                if (stop()) return;
+                detail::run_job(pool.acquire(), cfg_in, key, j, stop, local.stats, nullptr, local.rows);
+            }
+        }, tbb::simple_partitioner{}, ctx);
+
+        std::vector<StepDense> parts;
+        for (Local& l : acc) { out.stats.merge(l.stats); parts.push_back(std::move(l.rows)); }
+        out.heatmap = std::move(reduce_step_dense(parts)).to_heatmap();
+    });
+    return out;
+}
+
+// ---------- Replica-parallel hitting-time runner (small paths) ----------
+// Same jobs, seeds and distribution as run_jobs_hitting_time<Path<B>>, but each
+// TBB chunk feeds its jobs through a ReplicaPathEngine (Lanes replicas in flight).
+// Honors cfg.threads and cfg.shard; cancellation/deadline drop chunks not yet started.
+template <std::size_t B, std::size_t Lanes = 64, class SeedRng>
+inline HittingTimeStats
+run_jobs_hitting_time_replicas(const JobConfig& cfg_in, SeedRng& master_rng) {
+    const std::size_t J = (cfg_in.jobs == 0) ? 1 : cfg_in.jobs;
+    const int NT        = (cfg_in.threads > 0) ? cfg_in.threads : tbb::this_task_arena::max_concurrency();
+
+    const std::uint64_t key = core::batch_key(master_rng);
+
+    tbb::enumerable_thread_specific<HittingTimeStats> acc;
+    tbb::task_group_context ctx;
+    const BatchStop stop(cfg_in, ctx);
+    tbb::task_arena arena(NT);
+    arena.execute([&] {
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(cfg_in.shard.begin(J), cfg_in.shard.end(J), 4 * Lanes),
+                          [&](const tbb::blocked_range<std::size_t>& r) {
+            if (stop()) return;
+            HittingTimeStats& local = acc.local();
+            const core::schelling::ThresholdScope tau(cfg_in.tau ? *cfg_in.tau : core::schelling::current_threshold());
+            ReplicaPathEngine<B, Lanes> engine;
+            engine.run(key, r.begin(), r.size(), cfg_in.density, cfg_in.minority,
+                       [&](std::size_t, const RunResult& res) { detail::record_run(local, res); }, cfg_in.max_steps);
+        }, tbb::auto_partitioner{}, ctx);
+    });
+    HittingTimeStats out;
+    acc.combine_each([&](const HittingTimeStats& st) { out.merge(st); });
+    return out;
+}
+
+// ---------- Sequential (CI-width) hitting-time runner ----------
+struct SequentialResult {
+    HittingTimeStats stats{};       // jobs [0, jobs) exactly
+    std::size_t      jobs{0};       // stopping point
+    bool             converged{false};
+    double           rel_half_width{std::numeric_limits<double>::infinity()};
+};
+
+// Runs jobs 0, 1, 2, ... of a batch of cfg.jobs (the cap) with the usual
+// per-job seeds, in order of job index through a shared ticket counter. A
+// worker holding ticket j waits until j is within lookahead * threads of
+// the first unfinished job, so while one long run holds the prefix the
+// others neither run far past the stopping point nor pile up results.
+// Results are folded into the distribution as a contiguous prefix; each time
+// the prefix reaches a multiple of cfg.wave the stopping rule is evaluated on
+// it, and once it holds the group is cancelled, abandoning in-flight jobs.
+// The stopping point depends only on the seeds and cfg.wave (not on threads
+// or timing), and the returned stats equal run_jobs_hitting_time with
+// jobs = result.jobs. The CI is over settled runs; censored runs still count
+// toward jobs. cfg.cancel/cfg.deadline end the prefix where it stands.
+template <class Graph, class SeedRng>
+    requires GraphLike<Graph, SeedRng> && Resettable<Graph>
+inline SequentialResult
+run_jobs_hitting_time_sequential(const JobConfig& cfg_in, SeedRng& master_rng, std::size_t lookahead = 4) {
+    const std::size_t J = (cfg_in.jobs == 0) ? 1 : cfg_in.jobs;
+    const std::size_t W = (cfg_in.wave == 0) ? 1 : cfg_in.wave;
+    const int NT        = (cfg_in.threads > 0) ? cfg_in.threads : tbb::this_task_arena::max_concurrency();
+
+    const std::uint64_t key = core::batch_key(master_rng);
+
+    GraphPool<Graph> pool;
+    tbb::task_group_context ctx;
+    const BatchStop stop(cfg_in, ctx);
+
+    SequentialResult out;
+    // Finished jobs ahead of the prefix (reorder buffer): at most `window`
+    // entries, since no job starts that far past the first unfinished one.
+    const std::size_t window = lookahead * static_cast<std::size_t>(NT);
+    std::map<std::size_t, RunResult> done;
+    std::mutex prefix_mutex;
+    std::condition_variable advanced;
+    auto finish = [&](std::size_t j, const RunResult& r) {
+        {
+            const std::lock_guard lock(prefix_mutex);
+            if (out.converged) return;
+            done.emplace(j, r);
+            for (auto it = done.begin(); it != done.end() && it->first == out.jobs; it = done.erase(it)) {
+                detail::record_run(out.stats, it->second);
+                if (++out.jobs % W != 0 && out.jobs != J) continue;
+                out.rel_half_width = relative_ci_half_width(out.stats.settled(), cfg_in.ci_z);
+                if (out.rel_half_width <= cfg_in.ci_target) {
+                    out.converged = true;
+                    ctx.cancel_group_execution();
+                    break;
+                }
             }
-            return init;
-        },
-        std::plus<std::uint64_t>{});
+        }
+        advanced.notify_all();
+    };
+    // Block ticket j until it is inside the window; false if the batch stops
+    // meanwhile. The head job is always running (its ticket is inside), so
+    // the wait ends; the timeout only bounds how late a deadline is seen.
+    auto admit = [&](std::size_t j) {
+        std::unique_lock lock(prefix_mutex);
+        while (j >= out.jobs + window) {
+            if (out.converged || stop()) return false;
+            advanced.wait_for(lock, std::chrono::milliseconds(10));
+        }
+        return true;
+    };
 
-    return static_cast<size_t>(total);
+    std::atomic<std::size_t> next{0};
+    tbb::task_arena arena(NT);
+    arena.execute([&] {
+        tbb::parallel_for(0, NT, [&](int) {
+            for (std::size_t j; !stop() && (j = next.fetch_add(1, std::memory_order_relaxed)) < J;) {
+                if (!admit(j)) return;
+                core::Xoshiro256ss rng(core::job_seed(key, j));
+                const core::schelling::ThresholdScope tau(cfg_in.tau ? *cfg_in.tau : core::schelling::current_threshold());
+                const detail::JobRecording recording(cfg_in, j);
+                Graph& g = pool.acquire();
+                if (const auto res = sim::run_schelling_process_until(g, cfg_in.density, rng, cfg_in.minority, stop, cfg_in.max_steps))
+                    finish(j, *res);
+            }
+        }, ctx);
+    });
+    return out;
 }
 
 } // namespace sim
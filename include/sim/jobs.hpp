@@ -10,11 +10,12 @@
 
 namespace sim {
 
-// Seed J jobs deterministically using the master RNG (no races)
+// Materialized seeds of jobs [0, J) (same values as job_seed(batch_key, j)).
 template <class SeedRng>
 inline std::vector<std::uint64_t> seed_jobs(std::size_t J, SeedRng& master_rng) {
+    const std::uint64_t key = core::batch_key(master_rng);
     std::vector<std::uint64_t> seeds(J);
-    for (std::size_t i = 0; i < J; ++i) seeds[i] = core::splitmix_hash(master_rng());
+    for (std::size_t i = 0; i < J; ++i) seeds[i] = core::job_seed(key, i);
     return seeds;
 }
 
@@ -0,0 +1,187 @@
+// placement.hpp — optional CPU pinning and NUMA-node arenas for job runners
+//
+// A PlacementPolicy turns into one or more Domains, each a set of CPUs served
+// by its own task_arena whose workers are pinned (round-robin by arena slot)
+// to those CPUs. With per_node, there is one domain per NUMA node from
+// /sys/devices/system/node; per-worker graphs and stats are constructed by
+// the pinned worker on first use, so the kernel's first-touch policy backs
+// them with node-local pages. Without sysfs NUMA info, or on a single node,
+// this degrades to one domain; CPUs outside the process affinity mask are
+// dropped, and a failed pin leaves the thread where it was.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <tbb/task_arena.h>
+#include <tbb/task_scheduler_observer.h>
+
+namespace sim {
+
+struct PlacementPolicy {
+    std::vector<int> cores;     // CPUs workers may be pinned to; empty -> all allowed CPUs
+    bool             per_node{false};   // one arena per NUMA node
+
+    bool enabled() const noexcept { return per_node || !cores.empty(); }
+};
+
+// Linux cpulist syntax ("0-3,8,10-11"); nullopt on malformed input.
+inline std::optional<std::vector<int>> parse_cpu_list(std::string_view s) {
+    std::vector<int> cpus;
+    while (!s.empty() && (s.back() == '\n' || s.back() == ' ')) s.remove_suffix(1);
+    if (s.empty()) return cpus;
+    auto number = [](std::string_view t, int& out) {
+        if (t.empty() || t.size() > 9) return false;
+        out = 0;
+        for (char c : t) { if (c < '0' || c > '9') return false; out = out * 10 + (c - '0'); }
+        return true;
+    };
+    for (;;) {
+        const std::size_t comma = s.find(',');
+        const std::string_view item = s.substr(0, comma);
+        const std::size_t dash = item.find('-');
+        int lo = 0, hi = 0;
+        if (!number(item.substr(0, dash), lo)) return std::nullopt;
+        if (dash == std::string_view::npos) hi = lo;
+        else if (!number(item.substr(dash + 1), hi) || hi < lo) return std::nullopt;
+        for (int c = lo; c <= hi; ++c) cpus.push_back(c);
+        if (comma == std::string_view::npos) return cpus;
+        s.remove_prefix(comma + 1);
+    }
+}
+
+namespace detail {
+
+inline std::vector<int> allowed_cpus() {
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof set, &set) != 0) return cpus;
+    for (int c = 0; c < CPU_SETSIZE; ++c) if (CPU_ISSET(c, &set)) cpus.push_back(c);
+    return cpus;
+}
+
+// CPU lists of the NUMA nodes that have CPUs; empty if sysfs has no node info.
+inline std::vector<std::vector<int>> numa_node_cpus(const std::string& node_dir = "/sys/devices/system/node") {
+    auto read_list = [](const std::string& file) {
+        std::ifstream in(file);
+        std::string line;
+        if (!in || !std::getline(in, line)) return std::vector<int>{};
+        return parse_cpu_list(line).value_or(std::vector<int>{});
+    };
+    std::vector<std::vector<int>> nodes;
+    for (int n : read_list(node_dir + "/online")) {
+        auto cpus = read_list(node_dir + "/node" + std::to_string(n) + "/cpulist");
+        if (!cpus.empty()) nodes.push_back(std::move(cpus));
+    }
+    return nodes;
+}
+
+} // namespace detail
+
+// A group of CPUs with its share of the runner's threads.
+struct Domain {
+    std::vector<int> cpus;      // empty -> unpinned
+    int              threads{1};
+};
+
+// Split `threads` (0 -> one per CPU) across the policy's domains in
+// proportion to their CPU counts (largest remainders get the rounding
+// leftovers), so the shares add up to exactly `threads`. Domains left
+// without a thread are dropped. `allowed` is the affinity mask and `nodes`
+// the NUMA nodes' CPUs (empty: one domain).
+inline std::vector<Domain> make_domains(const PlacementPolicy& policy, int threads,
+                                        const std::vector<int>& allowed,
+                                        const std::vector<std::vector<int>>& nodes) {
+    auto usable = [&](const std::vector<int>& cpus) {
+        std::vector<int> out;
+        for (int c : cpus)
+            for (int a : allowed) if (a == c) { out.push_back(c); break; }
+        return out;
+    };
+    const std::vector<int> base = policy.cores.empty() ? allowed : usable(policy.cores);
+
+    std::vector<Domain> domains;
+    if (policy.per_node) {
+        for (const auto& node : nodes) {
+            std::vector<int> cpus;
+            for (int c : node)
+                for (int b : base) if (b == c) { cpus.push_back(c); break; }
+            if (!cpus.empty()) domains.push_back(Domain{std::move(cpus), 0});
+        }
+    }
+    if (domains.empty()) domains.push_back(Domain{base, 0});
+
+    std::size_t total_cpus = 0;
+    for (const auto& d : domains) total_cpus += d.cpus.size();
+    const int want = threads > 0 ? threads : static_cast<int>(total_cpus ? total_cpus : 1);
+    if (total_cpus == 0) {   // one unpinned domain
+        domains.resize(1);
+        domains[0].threads = want;
+        return domains;
+    }
+    std::vector<std::size_t> order(domains.size());
+    int given = 0;
+    for (std::size_t i = 0; i < domains.size(); ++i) {
+        domains[i].threads = static_cast<int>(static_cast<std::size_t>(want) * domains[i].cpus.size() / total_cpus);
+        given += domains[i].threads;
+        order[i] = i;
+    }
+    // Remainders want * cpus mod total_cpus, largest first (ties: lower index).
+    auto rem = [&](std::size_t i) { return static_cast<std::size_t>(want) * domains[i].cpus.size() % total_cpus; };
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return rem(a) > rem(b); });
+    for (std::size_t k = 0; given < want; ++k, ++given) ++domains[order[k]].threads;
+    std::erase_if(domains, [](const Domain& d) { return d.threads == 0; });
+    return domains;
+}
+
+// make_domains for this process: its affinity mask and sysfs NUMA nodes.
+inline std::vector<Domain> make_domains(const PlacementPolicy& policy, int threads) {
+    return make_domains(policy, threads, detail::allowed_cpus(),
+                        policy.per_node ? detail::numa_node_cpus() : std::vector<std::vector<int>>{});
+}
+
+// Pins each thread entering `arena` to cpus[slot % cpus.size()] and restores
+// the thread's previous mask when it leaves (the caller's thread joins
+// arenas it executes in).
+class PinningObserver : public tbb::task_scheduler_observer {
+public:
+    PinningObserver(tbb::task_arena& arena, std::vector<int> cpus)
+        : tbb::task_scheduler_observer(arena), cpus_(std::move(cpus)) {
+        if (!cpus_.empty()) observe(true);
+    }
+    ~PinningObserver() override { observe(false); }
+
+    void on_scheduler_entry(bool) override {
+        const int slot = tbb::this_task_arena::current_thread_index();
+        if (slot < 0) return;
+        cpu_set_t& saved = saved_mask_();
+        CPU_ZERO(&saved);
+        pthread_getaffinity_np(pthread_self(), sizeof saved, &saved);
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpus_[static_cast<std::size_t>(slot) % cpus_.size()], &set);
+        pthread_setaffinity_np(pthread_self(), sizeof set, &set);
+    }
+    void on_scheduler_exit(bool) override {
+        cpu_set_t& saved = saved_mask_();
+        if (CPU_COUNT(&saved) > 0) pthread_setaffinity_np(pthread_self(), sizeof saved, &saved);
+    }
+
+private:
+    static cpu_set_t& saved_mask_() {
+        thread_local cpu_set_t mask;
+        return mask;
+    }
+    std::vector<int> cpus_;
+};
+
+} // namespace sim
@@ -8,7 +8,7 @@ namespace sim {
 
 // Declare a custom OpenMP reduction for StepDense using merge_step_dense
 #pragma omp declare reduction (merge_step_dense : sim::StepDense : \
-    sim::merge_step_dense(omp_out, omp_in)) initializer(omp_priv = sim::StepDense{})
+    sim::merge_step_dense(omp_out, omp_in)) initializer(omp_priv = sim::StepDense(omp_orig.bins(), omp_orig.width()))
 
 } // namespace sim
 
@@ -0,0 +1,129 @@
+// replay.hpp — random access into a recorded run (see sim/trajectory.hpp)
+//
+// A Replay indexes one job of a trajectory file from its block headers: the
+// moves blocks and the keyframes the Recorder wrote (state blocks, see
+// sim/trajectory.hpp; the first holds the initial configuration), so opening
+// one costs O(blocks), not a pass over the moves. seek(g, t) loads the last keyframe at or before step t and applies
+// the recorded moves after it through pop_agent/place_agent: at most one
+// keyframe spacing (Recorder::default_keyframe_every), whatever the depth of
+// t. Moves and keyframes stay in the Reader's mapping, which must outlive
+// the Replay.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "sim/graph_concepts.hpp"
+#include "sim/trajectory.hpp"
+
+namespace sim {
+
+namespace detail {
+
+// pop_agent returns the color (Path, LollipopGraph) or an optional color (Clique).
+template <class Graph>
+inline void apply_move(Graph& g, std::uint64_t from, std::uint64_t to) {
+    const auto c = g.pop_agent(static_cast<core::size_t>(from));
+    if constexpr (std::is_same_v<std::remove_cv_t<decltype(c)>, std::optional<bool>>)
+        g.place_agent(static_cast<core::size_t>(to), c.value());
+    else
+        g.place_agent(static_cast<core::size_t>(to), static_cast<bool>(c));
+}
+
+} // namespace detail
+
+template <class Graph>
+    requires Checkpointable<Graph>
+class Replay {
+public:
+    // Seeks start from the job's recorded keyframes; throws if the file holds
+    // no step-0 keyframe of `job` (nothing recorded, or a Recorder that was
+    // not started) or keyframes of another graph type.
+    Replay(const trajectory::Reader& reader, std::uint64_t job) : Replay(reader, job, nullptr) {}
+
+    // `initial` is the job's configuration before its first move (e.g. a
+    // graph initialized from the job's seed, as sim::run_schelling_process_until
+    // does), used only if the file has no step-0 keyframe of `job`.
+    Replay(const trajectory::Reader& reader, std::uint64_t job, const Graph& initial) : Replay(reader, job, &initial) {}
+
+    std::uint64_t moves()     const noexcept { return moves_; }
+    // Step after the last recorded move (0 if the run made none); states
+    // from here on are final.
+    std::uint64_t end_step()  const noexcept { return end_step_; }
+    // Keyframes seeks start from, `initial` included if it is used.
+    std::size_t   keyframes() const noexcept { return keys_.size(); }
+
+    // Set g to the configuration at step t: after every recorded move made
+    // before step t (null moves leave it unchanged).
+    void seek(Graph& g, std::uint64_t t) const {
+        const auto it = std::upper_bound(keys_.begin(), keys_.end(), t,
+                                         [](std::uint64_t s, const Keyframe& k) { return s < k.step; });
+        const Keyframe& k = *(it - 1);   // keys_[0].step == 0
+        if (k.state) {
+            std::vector<std::uint64_t> words(Graph::state_words);
+            std::memcpy(words.data(), k.state, words.size() * sizeof(std::uint64_t));
+            g.load_state(words.data());
+        } else {
+            g.load_state(states_.data());
+        }
+        for (std::size_t b = k.block; b < blocks_.size(); ++b) {
+            for (trajectory::Cursor c = blocks_[b]; !c.done();) {
+                const trajectory::Move m = c.next();
+                if (m.step >= t) return;
+                detail::apply_move(g, m.from, m.to);
+            }
+        }
+    }
+
+private:
+    struct Keyframe {
+        std::uint64_t       step;     // configuration at this step
+        const std::uint8_t* state;    // save_state words in the file; nullptr: `initial`
+        std::size_t         block;    // first of blocks_ after it
+    };
+
+    Replay(const trajectory::Reader& reader, std::uint64_t job, const Graph* initial) {
+        constexpr std::uint64_t state_bytes = Graph::state_words * sizeof(std::uint64_t);
+        reader.for_each_block([&](const trajectory::BlockHeader& b, const std::uint8_t* payload) {
+            if (b.job != job) return;
+            if (b.kind == trajectory::BlockKind::moves && b.moves) {
+                blocks_.emplace_back(b, payload);
+                moves_ += b.moves;
+            } else if (b.kind == trajectory::BlockKind::state) {
+                if (b.bytes != state_bytes) throw std::runtime_error("replay: keyframes were recorded from another graph type");
+                keys_.push_back(Keyframe{b.first_step, payload, 0});
+            }
+        });
+        std::stable_sort(blocks_.begin(), blocks_.end(),
+                         [](const trajectory::Cursor& a, const trajectory::Cursor& b) { return a.step < b.step; });
+        std::stable_sort(keys_.begin(), keys_.end(), [](const Keyframe& a, const Keyframe& b) { return a.step < b.step; });
+        if (keys_.empty() || keys_.front().step != 0) {
+            if (!initial) throw std::runtime_error("replay: no initial configuration recorded for this job");
+            states_.resize(Graph::state_words);
+            initial->save_state(states_.data());
+            keys_.insert(keys_.begin(), Keyframe{0, nullptr, 0});
+        }
+        // Each keyframe resumes at the first block recorded after it.
+        for (Keyframe& k : keys_)
+            k.block = static_cast<std::size_t>(std::lower_bound(blocks_.begin(), blocks_.end(), k.step,
+                                                                [](const trajectory::Cursor& c, std::uint64_t s) { return c.step < s; })
+                                               - blocks_.begin());
+        // Only the last block is decoded here.
+        if (!blocks_.empty())
+            for (trajectory::Cursor c = blocks_.back(); !c.done();) end_step_ = c.next().step + 1;
+    }
+
+    std::uint64_t                   moves_{0};
+    std::uint64_t                   end_step_{0};
+    std::vector<trajectory::Cursor> blocks_;    // start of each of the job's blocks, in step order
+    std::vector<Keyframe>           keys_;
+    std::vector<std::uint64_t>      states_;    // `initial`
+};
+
+} // namespace sim
@@ -0,0 +1,135 @@
+// replica_path.hpp — replica-parallel Schelling engine for small paths
+//
+// Runs up to Lanes independent Path<B> processes side by side. Each replica
+// lives in one word (raw bit v+1 = vertex v, bits 0 and B+1 are empty guards),
+// stored structure-of-arrays across lanes, so the unhappy-mask kernel is a
+// dozen word ops per lane in a branch-free loop the compiler vectorizes
+// (4/8 lanes per instruction with AVX2/AVX-512).
+//
+// Each lane has its own RNG, reseeded with core::job_seed(key, job) when it
+// picks up a job, and consumes it exactly like sim::run_schelling_process on a Path<B>
+// (bulk init, then get_unhappy/get_unoccupied draws), so a job's hitting time
+// does not depend on which lane ran it or on the lane count.
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+#include "core/config.hpp"
+#include "core/random_bitset.hpp"
+#include "core/rng.hpp"
+#include "core/schelling_threshold.hpp"
+#include "graphs/detail/padded_bitset.hpp"
+#include "sim/init.hpp"
+#include "sim/sim.hpp"
+
+namespace sim {
+
+template <std::size_t B, std::size_t Lanes = 64>
+class ReplicaPathEngine {
+    static_assert(B >= 1 && B + 2 <= 64, "ReplicaPathEngine: a replica must fit one 64-bit word with guards");
+    static_assert(Lanes >= 1 && Lanes <= 64, "ReplicaPathEngine: lane set is tracked in one 64-bit mask");
+    using word_t = std::uint64_t;
+    static constexpr word_t inner = ((word_t(1) << B) - 1) << 1;
+
+public:
+    static constexpr std::size_t lanes = Lanes;
+
+    // Run jobs [first, first + n) of the batch keyed by `key` (job j seeded with
+    // core::job_seed(key, j)); on_done(job, RunResult) fires as
+    // each replica finishes, with the same result as
+    // sim::run_schelling_process_until under the same max_steps budget.
+    // A path can get stuck (every move leaves an agent unhappy), so a replica
+    // still unsettled after max_steps moves is retired censored at max_steps.
+    template <class OnDone>
+    void run(std::uint64_t key, std::size_t first, std::size_t n, double density, Minority minority, OnDone&& on_done,
+             std::uint64_t max_steps = ~std::uint64_t{0}) {
+        load_threshold_();
+        std::size_t next = first;
+        const std::size_t last = first + n;
+        std::uint64_t active = 0;
+        for (std::size_t l = 0; l < Lanes && next < last; ++l, ++next) {
+            load_(l, next, core::job_seed(key, next), density, minority);
+            active |= std::uint64_t{1} << l;
+        }
+        while (active) {
+            refresh_unhappy_();
+            for (std::uint64_t a = active; a; a &= a - 1) {
+                const std::size_t l = static_cast<std::size_t>(std::countr_zero(a));
+                const bool settled = unh_[l] == 0;
+                if (settled || steps_[l] == max_steps) {
+                    on_done(job_[l], settled
+                        ? RunResult{steps_[l] ? steps_[l] - 1 : 0, 0, false}
+                        : RunResult{max_steps, static_cast<core::count_t>(std::popcount(unh_[l])), true});
+                    if (next < last) { load_(l, next, core::job_seed(key, next), density, minority); ++next; }
+                    else          active &= ~(std::uint64_t{1} << l);
+                    continue;
+                }
+                step_(l);
+            }
+        }
+    }
+
+private:
+    // Threshold outcomes for the (frustration, neighbors) pairs a path vertex
+    // can see, as all-ones/all-zeros masks; (0, n) is never unhappy.
+    void load_threshold_() noexcept {
+        u11_ = word_t(0) - core::schelling::is_unhappy(1, 1);
+        u12_ = word_t(0) - core::schelling::is_unhappy(1, 2);
+        u22_ = word_t(0) - core::schelling::is_unhappy(2, 2);
+    }
+
+    // Same draws as initialize_graph_bulk on a Path<B>.
+    void load_(std::size_t l, std::size_t job, std::uint64_t seed, double density, Minority minority) {
+        rng_[l] = core::Xoshiro256ss(seed);
+        const core::count_t K = static_cast<core::count_t>(static_cast<double>(B) * density);
+        const auto occ = core::random_weight_bitset<B>(B, K, rng_[l]);
+        const auto col = core::random_weight_bitset_within(occ, minority_count(K, minority_share(minority)), rng_[l]);
+        occ_[l] = static_cast<word_t>(occ.data()[0]) << 1;
+        col_[l] = static_cast<word_t>(col.data()[0]) << 1;
+        steps_[l] = 0;
+        job_[l] = job;
+    }
+
+    // One pass over all lanes; no cross-lane dependencies.
+    void refresh_unhappy_() noexcept {
+        const word_t u11 = u11_, u12 = u12_, u22 = u22_;
+        for (std::size_t l = 0; l < Lanes; ++l) {
+            const word_t o = occ_[l], c = col_[l];
+            const word_t left = o << 1, right = o >> 1;           // neighbor v-1 / v+1 present
+            const word_t mis_l = left  & (c ^ (c << 1));
+            const word_t mis_r = right & (c ^ (c >> 1));
+            const word_t one = (left ^ right) & (mis_l | mis_r) & u11;
+            const word_t two = (left & right) & (((mis_l ^ mis_r) & u12) | (mis_l & mis_r & u22));
+            unh_[l] = o & (one | two);
+        }
+    }
+
+    // get_unhappy, get_unoccupied, pop, place — for one lane.
+    void step_(std::size_t l) noexcept {
+        auto& rng = rng_[l];
+        const word_t u = unh_[l];
+        const word_t vac = ~occ_[l] & inner;
+        std::uniform_int_distribution<std::size_t> pick_u(0, static_cast<std::size_t>(std::popcount(u)) - 1u);
+        const std::size_t from = graphs::detail::select_in_word(u, pick_u(rng));
+        std::uniform_int_distribution<std::size_t> pick_v(0, static_cast<std::size_t>(std::popcount(vac)) - 1u);
+        const std::size_t to = graphs::detail::select_in_word(vac, pick_v(rng));
+        const word_t c = (col_[l] >> from) & 1u;
+        occ_[l] ^= (word_t(1) << from) | (word_t(1) << to);
+        col_[l] = (col_[l] & ~(word_t(1) << from)) | (c << to);
+        ++steps_[l];
+    }
+
+    alignas(64) std::array<word_t, Lanes> occ_{};
+    alignas(64) std::array<word_t, Lanes> col_{};
+    alignas(64) std::array<word_t, Lanes> unh_{};
+    std::array<std::uint64_t, Lanes> steps_{};
+    std::array<std::size_t, Lanes> job_{};
+    std::array<core::Xoshiro256ss, Lanes> rng_{};
+    word_t u11_{0}, u12_{0}, u22_{0};
+};
+
+} // namespace sim
@@ -0,0 +1,136 @@
+// shard.hpp — split a batch's jobs across processes and merge their results
+//
+// A batch of J jobs is cut into n contiguous shards; shard i runs job indices
+// [i*J/n, (i+1)*J/n) with the same per-job seeds as the unsharded batch and
+// writes a partial-result file:
+//   PartialHeader | HittingTimeStats::write()
+// HittingTimeStats merges by integer addition, so merge_partials() over all n
+// shards is bit-identical (in memory and on disk) to a single-process run.
+// The header counts the jobs that ran to the end; a shard cut short by
+// --time-limit or a signal is still written, but merge_partials() refuses it.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "io/atomic_file.hpp"
+#include "sim/hitting_stats.hpp"
+
+namespace sim {
+
+struct ShardSpec {
+    std::size_t index{0};
+    std::size_t count{1};
+
+    std::size_t begin(std::size_t jobs) const noexcept { return bound_(jobs, index); }
+    std::size_t end(std::size_t jobs)   const noexcept { return bound_(jobs, index + 1); }
+
+private:
+    std::size_t bound_(std::size_t jobs, std::size_t i) const noexcept {
+        return static_cast<std::size_t>(wide_uint{jobs} * i / count);
+    }
+};
+
+// Everything that must agree between shards of one batch, plus the shard id.
+struct PartialHeader {
+    static constexpr std::array<char, 8> magic_value{'S', 'C', 'H', 'L', 'P', 'A', 'R', 'T'};
+    static constexpr std::uint32_t version_value = 2;
+
+    std::array<char, 8> magic{magic_value};
+    std::uint32_t version{version_value};
+    std::uint32_t header_bytes{sizeof(PartialHeader)};
+    std::uint64_t total_size{0};    // Graph::TotalSize
+    std::uint64_t jobs{0};          // J of the whole batch
+    std::uint64_t shard_index{0}, shard_count{1};
+    std::uint64_t tau_p{0}, tau_q{0};
+    double        density{0.0}, minority{0.0};
+    std::uint64_t max_steps{0};
+    std::uint64_t seed{0};          // master seed the per-job seeds are drawn from
+    std::uint64_t completed{0};     // jobs that settled or used up max_steps
+    std::uint64_t interrupted{0};   // jobs a deadline/cancel cut off (censored)
+
+    ShardSpec shard() const noexcept {
+        return { .index = static_cast<std::size_t>(shard_index), .count = static_cast<std::size_t>(shard_count) };
+    }
+    // Jobs in this shard's range; the shard is complete when all of them ran to the end.
+    std::uint64_t expected() const noexcept {
+        const std::size_t J = static_cast<std::size_t>(jobs);
+        return shard().end(J) - shard().begin(J);
+    }
+    bool complete() const noexcept { return interrupted == 0 && completed == expected(); }
+
+    bool same_batch(const PartialHeader& o) const noexcept {
+        return total_size == o.total_size && jobs == o.jobs && shard_count == o.shard_count
+            && tau_p == o.tau_p && tau_q == o.tau_q && density == o.density && minority == o.minority
+            && max_steps == o.max_steps && seed == o.seed;
+    }
+};
+static_assert(sizeof(PartialHeader) % 8 == 0);
+
+struct PartialResult {
+    PartialHeader    header{};
+    HittingTimeStats stats{};
+};
+
+// Write `part` to `file` (atomically replaced, see io/atomic_file.hpp).
+inline void write_partial(const std::filesystem::path& file, const PartialResult& part) {
+    io::atomic_write_file(file, [&](std::ostream& out) {
+        out.write(reinterpret_cast<const char*>(&part.header), sizeof part.header);
+        part.stats.write(out);
+    });
+}
+
+inline PartialResult read_partial(const std::filesystem::path& file) {
+    std::ifstream in(file, std::ios::binary);
+    if (!in) throw std::runtime_error("read_partial: cannot open " + file.string());
+    PartialResult part;
+    in.read(reinterpret_cast<char*>(&part.header), sizeof part.header);
+    const auto& h = part.header;
+    if (!in || h.magic != PartialHeader::magic_value || h.version != PartialHeader::version_value
+        || h.header_bytes != sizeof(PartialHeader))
+        throw std::runtime_error("read_partial: " + file.string() + " is not a partial result of this format version");
+    if (!part.stats.read(in) || in.peek() != std::ifstream::traits_type::eof())
+        throw std::runtime_error("read_partial: " + file.string() + " is truncated or corrupt");
+    return part;
+}
+
+// Combine the n shards of one batch (any order) into the unsharded result,
+// whose header reads shard 0 of 1. Throws unless the parts come from the same
+// batch, cover every shard exactly once, and each ran all of its jobs.
+inline PartialResult merge_partials(const std::vector<PartialResult>& parts) {
+    if (parts.empty()) throw std::runtime_error("merge_partials: no partial results");
+    const PartialHeader& first = parts.front().header;
+    if (parts.size() != first.shard_count)
+        throw std::runtime_error("merge_partials: expected " + std::to_string(first.shard_count)
+                                 + " shards, got " + std::to_string(parts.size()));
+    std::vector<bool> seen(parts.size(), false);
+    for (const auto& p : parts) {
+        if (!p.header.same_batch(first))
+            throw std::runtime_error("merge_partials: shards come from different batches");
+        if (p.header.shard_index >= seen.size() || seen[p.header.shard_index])
+            throw std::runtime_error("merge_partials: shard " + std::to_string(p.header.shard_index)
+                                     + " is missing a sibling or given twice");
+        seen[p.header.shard_index] = true;
+        if (!p.header.complete())
+            throw std::runtime_error("merge_partials: shard " + std::to_string(p.header.shard_index) + " completed "
+                                     + std::to_string(p.header.completed) + " of " + std::to_string(p.header.expected())
+                                     + " jobs (" + std::to_string(p.header.interrupted) + " cut off); rerun it");
+    }
+
+    PartialResult merged;
+    merged.header = first;
+    merged.header.shard_index = 0;
+    merged.header.shard_count = 1;
+    merged.header.completed   = merged.header.jobs;
+    for (const auto& p : parts) merged.stats.merge(p.stats);
+    return merged;
+}
+
+} // namespace sim
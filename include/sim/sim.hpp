@@ -1,11 +1,19 @@
 // sim.hpp — generic Schelling process helpers over GraphLike graphs
 #pragma once
+#include <bit>
 #include <concepts>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <utility>
 #include <vector>
 #include <algorithm>
 #include "sim/graph_concepts.hpp"
 #include "core/config.hpp"
 #include "sim/init.hpp"
+#if SCHELLING_RECORD_TRAJECTORIES
+#include "sim/trajectory.hpp"
+#endif
 
 namespace sim {
 
@@ -18,22 +26,137 @@ template <class G, class URBG>
 inline core::count_t schelling_step(G& graph, [[maybe_unused]] double density, URBG& rng) {
     const core::size_t from = graph.get_unhappy(rng);
     const core::size_t to   = graph.get_unoccupied(rng);
-    graph.place_agent(to, graph.pop_agent(from));
+    const auto color = graph.pop_agent(from);
+    graph.place_agent(to, color);
+#if SCHELLING_RECORD_TRAJECTORIES
+    trajectory::on_move(graph, from, to, static_cast<bool>(color), 0);
+#endif
     return graph.unhappy_count();
 } 
 
 
+// Fast-forward variant: skips the run of null moves, then applies one
+// effective move. Returns the number of null steps skipped (max() if the
+// graph admits no effective move; the graph is then left unchanged).
+template <class G, class URBG>
+    requires GraphLike<G, URBG> && NullMoveSkipping<G, URBG>
+inline std::uint64_t schelling_step_skipping(G& graph, URBG& rng) {
+    core::size_t from{}, to{};
+    const std::uint64_t skipped = graph.sample_effective_move(rng, from, to);
+    if (skipped == std::numeric_limits<std::uint64_t>::max()) return skipped;
+    const auto color = graph.pop_agent(from);
+    graph.place_agent(to, color);
+#if SCHELLING_RECORD_TRAJECTORIES
+    trajectory::on_move(graph, from, to, static_cast<bool>(color), skipped);
+#endif
+    return skipped;
+}
+
 // run_schelling_process removed in favor of run_schelling_process
 
+// Stop predicate for runs that are never interrupted.
+struct NeverStop {
+    constexpr bool operator()() const noexcept { return false; }
+};
+
+// Observer that records nothing (compiles away). An observer is called as
+// observe(t0, n, unhappy): the states after t0, t0+1, ..., t0+n-1 moves all
+// had `unhappy` unhappy agents (see continue_schelling_process).
+struct NoObserve {
+    constexpr void operator()(std::uint64_t, std::uint64_t, core::count_t) const noexcept {}
+};
+
+// Outcome of one budgeted run. A censored run either hit the step budget
+// or can never settle; `steps` is then the number of steps observed so far
+// (hitting time >= steps) and `unhappy` the unhappy_count it was left with.
+struct RunResult {
+    std::uint64_t steps{0};
+    core::count_t unhappy{0};
+    bool          censored{false};
+};
+
+// Hitting time = number of steps that leave unhappy agents behind. Null moves
+// never change unhappy_count, so each skipped one counts as a step.
+//
+// Core loop, from an initialized graph whose first `hitting_time` steps are
+// already done. A run still unsettled after max_steps counted steps is
+// censored there. Every SCHELLING_STOP_POLL_STEPS moves, at a step boundary
+// (graph, rng and hitting_time describe a resumable state), poll(hitting_time)
+// is called; once it returns true the run is abandoned and nullopt returned.
+// observe() sees every state from the one after hitting_time moves up to the
+// settled one (or up to the budget), in order, null-move runs in one call.
+template <class G, class URBG, class Poll, class Observe = NoObserve>
+    requires GraphLike<G, URBG> && std::predicate<Poll&, std::uint64_t>
+          && std::invocable<Observe&, std::uint64_t, std::uint64_t, core::count_t>
+inline std::optional<RunResult> continue_schelling_process(G& graph, [[maybe_unused]] double density, URBG& rng,
+                                                           std::uint64_t hitting_time, Poll&& poll,
+                                                           std::uint64_t max_steps = std::numeric_limits<std::uint64_t>::max(),
+                                                           Observe&& observe = Observe{}) {
+    static_assert(std::has_single_bit(static_cast<unsigned>(SCHELLING_STOP_POLL_STEPS)),
+                  "SCHELLING_STOP_POLL_STEPS must be a power of two");
+    constexpr std::uint32_t poll_mask = SCHELLING_STOP_POLL_STEPS - 1;
+    std::uint32_t moves = 0;
+    core::count_t unhappy = graph.unhappy_count();
+    if (unhappy == 0) { observe(hitting_time, 1, 0); return RunResult{hitting_time, 0, false}; }
+    if constexpr (SCHELLING_SKIP_NULL_MOVES && NullMoveSkipping<G, URBG>) {
+        for (;;) {
+            if (hitting_time >= max_steps) return RunResult{max_steps, unhappy, true};
+            if ((++moves & poll_mask) == 0 && poll(hitting_time)) [[unlikely]] return std::nullopt;
+            const std::uint64_t skipped = schelling_step_skipping(graph, rng);
+            if (skipped == std::numeric_limits<std::uint64_t>::max()) {
+                observe(hitting_time, 1, unhappy);
+                return RunResult{hitting_time, unhappy, true};
+            }
+            // The null run alone exhausts the budget; unhappy_count was constant over it.
+            if (skipped >= max_steps - hitting_time) {
+                observe(hitting_time, max_steps - hitting_time, unhappy);
+                return RunResult{max_steps, unhappy, true};
+            }
+            observe(hitting_time, skipped + 1, unhappy);
+            hitting_time += skipped;
+            unhappy = graph.unhappy_count();
+            if (unhappy == 0) { observe(hitting_time + 1, 1, 0); return RunResult{hitting_time, 0, false}; }
+            ++hitting_time;
+        }
+    } else {
+        for (;;) {
+            if (hitting_time >= max_steps) return RunResult{max_steps, unhappy, true};
+            if ((++moves & poll_mask) == 0 && poll(hitting_time)) [[unlikely]] return std::nullopt;
+            observe(hitting_time, 1, unhappy);
+            unhappy = schelling_step(graph, density, rng);
+            if (unhappy == 0) { observe(hitting_time + 1, 1, 0); return RunResult{hitting_time, 0, false}; }
+            ++hitting_time;
+        }
+    }
+}
+
+// Full run from a fresh initialization. `minority` is the color-1 share of
+// the initial agents (see sim/init.hpp). stop() is polled as above (or
+// stop(steps), with the steps made so far); the graph is left mid-run, in
+// a consistent state, when it fires.
+template <class G, class URBG, class Stop, class Observe = NoObserve>
+    requires GraphLike<G, URBG> && (std::predicate<Stop&> || std::predicate<Stop&, std::uint64_t>)
+inline std::optional<RunResult> run_schelling_process_until(G& graph, double density, URBG& rng,
+                                                            Minority minority, Stop&& stop,
+                                                            std::uint64_t max_steps = std::numeric_limits<std::uint64_t>::max(),
+                                                            Observe&& observe = Observe{}) {
+    initialize_graph(graph, density, rng, minority);
+#if SCHELLING_RECORD_TRAJECTORIES
+    trajectory::on_start(graph);
+#endif
+    return continue_schelling_process(graph, density, rng, 0, [&](std::uint64_t steps) {
+        if constexpr (std::predicate<Stop&, std::uint64_t>) return static_cast<bool>(stop(steps));
+        else return static_cast<bool>(stop());
+    }, max_steps, std::forward<Observe>(observe));
+}
+
+// Unbudgeted, uninterruptible run: the hitting time, or max() for a run that
+// can never settle.
 template <class G, class URBG>
     requires GraphLike<G, URBG>
-inline size_t run_schelling_process(G& graph, double density, URBG& rng) {
-    initialize_graph(graph, density, rng);
-    std::size_t hitting_time = 0;
-    if (graph.unhappy_count() == 0) return 0;
-    while (schelling_step(graph, density, rng) > 0) ++hitting_time;
-    return hitting_time;
+inline size_t run_schelling_process(G& graph, double density, URBG& rng, Minority minority = {}) {
+    const RunResult r = *run_schelling_process_until(graph, density, rng, minority, NeverStop{});
+    return r.censored ? std::numeric_limits<size_t>::max() : static_cast<size_t>(r.steps);
 }
 
-
 } // namespace sim
@@ -1,35 +1,26 @@
-// step_dense.hpp — heatmap row types and helpers (no logic change)
+// step_dense.hpp — exact per-step heatmap rows in one flat arena
+//
+// StepDense holds rows x bins counters row-major in a single std::vector.
+// Rows are added in chunks (about kChunkCells counters at a time,
+// zero-filled, geometric capacity growth), so a run of thousands of steps
+// costs a handful of allocations instead of one per row. merge is one
+// contiguous add loop the compiler vectorizes, reduce_step_dense merges many
+// parts as a parallel pairwise tree, and to_heatmap moves the arena into a
+// Heatmap (no copy).
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <stdexcept>
+#include <utility>
 #include <vector>
-#include <algorithm>
 
-namespace sim {
+#include <tbb/parallel_for.h>
 
-// Dense per-step rows: step -> row (bins length)
-using StepDense = std::vector<std::vector<std::uint64_t>>;
-
-// Merge helper for OpenMP reduction: assumes rows are either empty or sized to bins
-inline void merge_step_dense(StepDense& dst, const StepDense& src) {
-    if (src.size() > dst.size()) dst.resize(src.size());
-    for (std::size_t s = 0; s < src.size(); ++s) {
-        const auto& sr = src[s];
-        if (sr.empty()) continue;
-        auto& dr = dst[s];
-        if (dr.empty()) { dr = sr; continue; }
-        const std::size_t B = dr.size();
-        for (std::size_t j = 0; j < B; ++j) dr[j] += sr[j];
-    }
-}
+#include "core/config.hpp"
 
-// Ensure a step row exists and is sized to bins (no-op if already present)
-inline void ensure_step_row(StepDense& result, std::size_t s, std::size_t bins) {
-    if (s >= result.size()) result.resize(s + 1);
-    auto& row = result[s];
-    if (row.empty()) row.assign(bins, 0ull);
-}
+namespace sim {
 
 // Heatmap dense matrix representation
 struct Heatmap {
@@ -38,17 +29,108 @@ struct Heatmap {
     std::vector<std::uint64_t> data; // row-major rows × bins
 };
 
-inline Heatmap to_dense(const StepDense& dense, std::size_t bins) {
-    Heatmap out; out.bins = bins; out.rows = dense.size();
-    out.data.assign(out.rows * out.bins, 0ull);
-    for (std::size_t r = 0; r < out.rows; ++r) {
-        const auto& row = dense[r];
-        if (row.empty()) continue;
-        std::copy(row.begin(), row.begin() + std::min<std::size_t>(row.size(), out.bins),
-                  out.data.begin() + static_cast<std::ptrdiff_t>(r * out.bins));
+class StepDense {
+public:
+    static constexpr std::size_t kChunkCells = std::size_t{1} << 16;
+
+    StepDense() = default;
+    // Column c counts unhappy values [c*width, (c+1)*width).
+    explicit StepDense(std::size_t bins, std::size_t width = 1) : bins_(bins), width_(width ? width : 1) {}
+
+    std::size_t bins()  const noexcept { return bins_; }
+    std::size_t width() const noexcept { return width_; }
+    std::size_t rows() const noexcept { return rows_; }
+    bool        empty() const noexcept { return rows_ == 0; }
+
+    std::uint64_t*       row(std::size_t s) noexcept       { return data_.data() + s * bins_; }
+    const std::uint64_t* row(std::size_t s) const noexcept { return data_.data() + s * bins_; }
+
+    // Make rows [0, n) exist (new rows are zero); grows in whole chunks.
+    void ensure_rows(std::size_t n) {
+        if (n <= rows_) return;
+        const std::size_t chunk   = std::max<std::size_t>(1, kChunkCells / std::max<std::size_t>(bins_, 1));
+        const std::size_t chunked = (n + chunk - 1) / chunk * chunk;
+        if (chunked * bins_ > data_.size()) {
+            if (chunked * bins_ > data_.capacity()) data_.reserve(std::max(chunked * bins_, 2 * data_.capacity()));
+            data_.resize(chunked * bins_, 0);
+        }
+        rows_ = n;
+    }
+
+    // Observer hook (see sim::NoObserve): states t0 .. t0+n-1 had `unhappy`;
+    // counts beyond the last bin go to the last bin.
+    void operator()(std::uint64_t t0, std::uint64_t n, core::count_t unhappy) {
+        if (n == 0) return;
+        ensure_rows(static_cast<std::size_t>(t0 + n));
+        const std::size_t col = std::min<std::size_t>(static_cast<std::size_t>(unhappy) / width_, bins_ - 1);
+        std::uint64_t* cell = data_.data() + static_cast<std::size_t>(t0) * bins_ + col;
+        for (std::uint64_t i = 0; i < n; ++i, cell += bins_) ++*cell;
+    }
+
+    // this += o (o may have more or fewer rows). Throws std::invalid_argument
+    // unless this is empty (bins 0) or has o's bins and width.
+    void merge(const StepDense& o) {
+        if (o.rows_ == 0) return;
+        if (bins_ == 0) { bins_ = o.bins_; width_ = o.width_; }
+        if (bins_ != o.bins_ || width_ != o.width_)
+            throw std::invalid_argument("StepDense::merge: bins or bin width differ");
+        ensure_rows(o.rows_);
+        add_(data_.data(), o.data_.data(), o.rows_ * bins_);
+    }
+
+    // Hand the arena to a Heatmap (rows x bins), leaving this empty.
+    Heatmap to_heatmap() && {
+        data_.resize(rows_ * bins_);
+        Heatmap out{ bins_, rows_, std::move(data_) };
+        rows_ = 0;
+        data_.clear();
+        return out;
+    }
+
+private:
+    static void add_(std::uint64_t* __restrict dst, const std::uint64_t* __restrict src, std::size_t n) noexcept {
+        for (std::size_t i = 0; i < n; ++i) dst[i] += src[i];
+    }
+
+    std::size_t bins_{0};
+    std::size_t width_{1};
+    std::size_t rows_{0};
+    std::vector<std::uint64_t> data_;
+};
+
+// Merge helper (OpenMP reduction in sim/reductions.hpp, single merges)
+inline void merge_step_dense(StepDense& dst, const StepDense& src) { dst.merge(src); }
+
+// Ensure a step row exists and is sized to bins (no-op if already present)
+inline void ensure_step_row(StepDense& result, std::size_t s, std::size_t bins) {
+    if (result.bins() == 0) result = StepDense(bins);
+    result.ensure_rows(s + 1);
+}
+
+// Sum of all parts, as a pairwise tree: log2(P) levels, the merges of a
+// level run in parallel. Parts are consumed; the result is moved out of
+// parts[0].
+inline StepDense reduce_step_dense(std::vector<StepDense>& parts) {
+    if (parts.empty()) return StepDense{};
+    for (std::size_t stride = 1; stride < parts.size(); stride *= 2) {
+        const std::size_t pairs = (parts.size() + 2 * stride - 1) / (2 * stride);
+        tbb::parallel_for(std::size_t{0}, pairs, [&](std::size_t p) {
+            const std::size_t dst = p * 2 * stride, src = dst + stride;
+            if (src < parts.size()) { parts[dst].merge(parts[src]); parts[src] = StepDense{}; }
+        });
     }
-    return out;
+    return std::move(parts[0]);
 }
 
-} // namespace sim
+inline Heatmap to_dense(StepDense dense, std::size_t bins) {
+    if (dense.bins() != bins && !dense.empty()) {
+        Heatmap out{ bins, dense.rows(), std::vector<std::uint64_t>(dense.rows() * bins, 0) };
+        const std::size_t b = std::min(bins, dense.bins());
+        for (std::size_t r = 0; r < dense.rows(); ++r)
+            std::copy(dense.row(r), dense.row(r) + b, out.data.begin() + static_cast<std::ptrdiff_t>(r * bins));
+        return out;
+    }
+    return std::move(dense).to_heatmap();
+}
 
+} // namespace sim
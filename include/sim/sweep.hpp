@@ -0,0 +1,292 @@
+// sweep.hpp — many (tau, density, graph size) points in one process
+//
+// run_sweep schedules every (point, job) pair of a grid into one TBB arena,
+// interleaved job-major so all points progress together and a cancelled
+// sweep still has results everywhere. Each task installs its point's
+// threshold with core::schelling::ThresholdScope (no global state), takes a
+// graph of the point's size from that size's GraphPool and records into its
+// worker's per-point HittingTimeStats; the accumulators merge exactly.
+// Sizes are the compiled graph types of a GraphList, so one binary covers
+// every size of the grid.
+//
+// With cfg.common_random_numbers, job j of every point starts from job j's
+// seed (core::job_seed(key, j), as in run_jobs_hitting_time) split into
+// occupancy, color and dynamics streams, so points that differ only in tau
+// start from the same configuration and draw the same dynamics numbers.
+// paired_differences() then compares points job by job.
+//
+// Results go to a columnar binary file (SweepFileHeader, then one column of
+// `points` 8-byte values per entry of sweep_columns, in order) and/or a CSV
+// with the same columns.
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+#include <tbb/partitioner.h>
+#include <tbb/task_arena.h>
+
+#include "core/rng.hpp"
+#include "core/schelling_threshold.hpp"
+#include "io/atomic_file.hpp"
+#include "sim/graph_pool.hpp"
+#include "sim/hitting_stats.hpp"
+#include "sim/job_handler.hpp"
+#include "sim/sim.hpp"
+
+namespace sim {
+
+// The graph types a sweep can use (distinct types), addressed by index.
+template <class... Graphs>
+struct GraphList {
+    static constexpr std::size_t count = sizeof...(Graphs);
+    static constexpr std::array<std::size_t, count> total_sizes{static_cast<std::size_t>(Graphs::TotalSize)...};
+};
+
+struct SweepPoint {
+    core::schelling::PqThreshold tau{};
+    double                       density{0.8};
+    std::size_t                  graph{0};     // index into the GraphList
+};
+
+namespace detail {
+
+// f.template operator()<G>() for the i-th type of Graphs.
+template <class... Graphs, class F>
+inline void with_graph(std::size_t i, F&& f) {
+    std::size_t k = 0;
+    (void)((k++ == i ? (f.template operator()<Graphs>(), true) : false) || ...);
+}
+
+// Job j of point k (see run_sweep for the seeding).
+template <class Graph, class Stop>
+inline std::optional<RunResult> run_sweep_job(Graph& g, const SweepPoint& pt, const JobConfig& cfg, std::uint64_t key,
+                                              std::size_t k, std::size_t j, Stop& stop) {
+    if (!cfg.common_random_numbers) {
+        core::Xoshiro256ss rng(core::job_seed(core::job_seed(key, k), j));
+        return sim::run_schelling_process_until(g, pt.density, rng, cfg.minority, stop, cfg.max_steps);
+    }
+    const std::uint64_t seed = core::job_seed(key, j);
+    core::Xoshiro256ss occ(core::stream_seed(seed, core::Stream::occupancy));
+    core::Xoshiro256ss col(core::stream_seed(seed, core::Stream::colors));
+    core::Xoshiro256ss dyn(core::stream_seed(seed, core::Stream::dynamics));
+    initialize_graph_streams(g, pt.density, occ, col, cfg.minority);
+    return sim::continue_schelling_process(g, pt.density, dyn, 0, [&](std::uint64_t) { return stop(); }, cfg.max_steps);
+}
+
+} // namespace detail
+
+// A job's entry in run_sweep's `times`: settled hitting time, or this.
+inline constexpr std::uint64_t sweep_no_time = no_hitting_time;
+
+// Stats of each point, in points' order, over cfg.jobs jobs per point. Job j
+// of point k is seeded with core::job_seed(core::job_seed(key, k), j), or as
+// described above with cfg.common_random_numbers. cfg.minority, max_steps,
+// threads, cancel and deadline apply to every point; shards, placement and
+// sequential stopping are not used. If `times` is given it receives the
+// points x jobs matrix (row-major) of settled hitting times, sweep_no_time
+// for censored or dropped jobs.
+template <class... Graphs, class SeedRng>
+inline std::vector<HittingTimeStats>
+run_sweep(GraphList<Graphs...>, const std::vector<SweepPoint>& points, const JobConfig& cfg, SeedRng& master_rng,
+          std::vector<std::uint64_t>* times = nullptr) {
+    for (const SweepPoint& pt : points)
+        if (pt.graph >= sizeof...(Graphs)) throw std::invalid_argument("run_sweep: graph index out of range");
+    const std::size_t J  = (cfg.jobs == 0) ? 1 : cfg.jobs;
+    const std::size_t P  = points.size();
+    const int         NT = (cfg.threads > 0) ? cfg.threads : tbb::this_task_arena::max_concurrency();
+    const std::uint64_t key = core::batch_key(master_rng);
+    if (times) times->assign(P * J, sweep_no_time);
+
+    std::tuple<GraphPool<Graphs>...> pools;
+    tbb::enumerable_thread_specific<std::vector<HittingTimeStats>> local([&] { return std::vector<HittingTimeStats>(P); });
+    tbb::task_group_context ctx;
+    const BatchStop stop(cfg, ctx);
+    tbb::task_arena arena(NT);
+    arena.execute([&] {
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, P * J, 1), [&](const tbb::blocked_range<std::size_t>& r) {
+            std::vector<HittingTimeStats>& acc = local.local();
+            for (std::size_t i = r.begin(); i != r.end(); ++i) {
+                if (stop()) return;
+                const std::size_t k = i % P, j = i / P;
+                const SweepPoint& pt = points[k];
+                const core::schelling::ThresholdScope tau(pt.tau);
+                detail::with_graph<Graphs...>(pt.graph, [&]<class Graph>() {
+                    Graph& g = std::get<GraphPool<Graph>>(pools).acquire();
+                    if (const auto res = detail::run_sweep_job(g, pt, cfg, key, k, j, stop)) {
+                        detail::record_run(acc[k], *res);
+                        if (times && !res->censored) (*times)[k * J + j] = res->steps;
+                    }
+                });
+            }
+        }, tbb::simple_partitioner{}, ctx);
+    });
+
+    std::vector<HittingTimeStats> out(P);
+    for (const auto& part : local)
+        for (std::size_t k = 0; k < P; ++k) out[k].merge(part[k]);
+    return out;
+}
+
+// Point k minus the baseline point, over the jobs settled at both (paired
+// by job index). half_width is the z-interval on the mean difference;
+// unpaired_half_width is what independent samples of the same spread would
+// give, so their ratio is the gain from common random numbers.
+struct PairedDiff {
+    std::uint64_t pairs{0};
+    double        mean{0.0}, stddev{0.0};
+    double        half_width{0.0}, unpaired_half_width{0.0};
+};
+
+inline PairedDiff paired_difference(const std::vector<std::uint64_t>& times, std::size_t jobs, std::size_t k,
+                                    std::size_t baseline, double z = 1.96) {
+    PairedDiff out;
+    double mean_d = 0.0, m2_d = 0.0, mean_a = 0.0, m2_a = 0.0, mean_b = 0.0, m2_b = 0.0;
+    auto welford = [](double x, double n, double& mean, double& m2) {
+        const double delta = x - mean;
+        mean += delta / n;
+        m2 += delta * (x - mean);
+    };
+    for (std::size_t j = 0; j < jobs; ++j) {
+        const std::uint64_t a = times[k * jobs + j], b = times[baseline * jobs + j];
+        if (a == sweep_no_time || b == sweep_no_time) continue;
+        const double n = static_cast<double>(++out.pairs);
+        welford(static_cast<double>(a) - static_cast<double>(b), n, mean_d, m2_d);
+        welford(static_cast<double>(a), n, mean_a, m2_a);
+        welford(static_cast<double>(b), n, mean_b, m2_b);
+    }
+    if (out.pairs < 2) { out.mean = mean_d; return out; }
+    const double n = static_cast<double>(out.pairs);
+    out.mean = mean_d;
+    out.stddev = std::sqrt(m2_d / (n - 1.0));
+    out.half_width = z * out.stddev / std::sqrt(n);
+    out.unpaired_half_width = z * std::sqrt((m2_a + m2_b) / (n - 1.0) / n);
+    return out;
+}
+
+// ---------- Output ----------
+
+// One row per point: the grid coordinates and a summary of its stats.
+struct SweepRow {
+    std::uint64_t tau_p{0}, tau_q{0};
+    double        density{0.0};
+    std::uint64_t total_size{0};
+    std::uint64_t runs{0}, censored{0};
+    double        mean{0.0}, stddev{0.0};       // settled runs
+    std::uint64_t p50{0}, p90{0}, p99{0};       // settled runs
+};
+
+// Column order of the binary file and the CSV.
+inline constexpr std::array<const char*, 11> sweep_columns{
+    "tau_p", "tau_q", "density", "total_size", "runs", "censored", "mean", "stddev", "p50", "p90", "p99"};
+
+template <class... Graphs>
+inline std::vector<SweepRow> summarize_sweep(GraphList<Graphs...> graphs, const std::vector<SweepPoint>& points,
+                                             const std::vector<HittingTimeStats>& stats) {
+    const auto& total_sizes = graphs.total_sizes;
+    std::vector<SweepRow> rows;
+    rows.reserve(points.size());
+    for (std::size_t k = 0; k < points.size() && k < stats.size(); ++k) {
+        const auto& s = stats[k].settled();
+        rows.push_back(SweepRow{points[k].tau.p, points[k].tau.q, points[k].density, total_sizes[points[k].graph],
+                                stats[k].count(), stats[k].censored_count(), s.mean(), s.stddev(),
+                                s.quantile(0.5), s.quantile(0.9), s.quantile(0.99)});
+    }
+    return rows;
+}
+
+struct SweepFileHeader {
+    static constexpr std::array<char, 8> magic_value{'S', 'C', 'H', 'L', 'S', 'W', 'E', 'P'};
+    static constexpr std::uint32_t version_value = 1;
+
+    std::array<char, 8> magic{magic_value};
+    std::uint32_t version{version_value};
+    std::uint32_t header_bytes{sizeof(SweepFileHeader)};
+    std::uint64_t points{0};
+    std::uint64_t columns{sweep_columns.size()};
+    std::uint64_t jobs{0};          // jobs per point
+    std::uint64_t seed{0};          // master seed
+    std::uint64_t max_steps{0};
+    double        minority{0.0};
+};
+static_assert(sizeof(SweepFileHeader) % 8 == 0);
+
+namespace detail {
+
+// The columns of a row as 8-byte words (doubles bit-copied), in sweep_columns order.
+inline std::array<std::uint64_t, sweep_columns.size()> sweep_words(const SweepRow& r) noexcept {
+    auto bits = [](double d) { std::uint64_t w; std::memcpy(&w, &d, sizeof w); return w; };
+    return {r.tau_p, r.tau_q, bits(r.density), r.total_size, r.runs, r.censored,
+            bits(r.mean), bits(r.stddev), r.p50, r.p90, r.p99};
+}
+
+inline SweepRow sweep_row(const std::array<std::uint64_t, sweep_columns.size()>& w) noexcept {
+    auto dbl = [](std::uint64_t u) { double d; std::memcpy(&d, &u, sizeof d); return d; };
+    return SweepRow{w[0], w[1], dbl(w[2]), w[3], w[4], w[5], dbl(w[6]), dbl(w[7]), w[8], w[9], w[10]};
+}
+
+} // namespace detail
+
+// Columnar binary (atomically replaced, see io/atomic_file.hpp).
+inline void write_sweep_columns(const std::filesystem::path& file, SweepFileHeader header, const std::vector<SweepRow>& rows) {
+    header.points = rows.size();
+    std::vector<std::uint64_t> cols(sweep_columns.size() * rows.size());
+    for (std::size_t k = 0; k < rows.size(); ++k) {
+        const auto w = detail::sweep_words(rows[k]);
+        for (std::size_t c = 0; c < w.size(); ++c) cols[c * rows.size() + k] = w[c];
+    }
+    io::atomic_write_file(file, [&](std::ostream& out) {
+        out.write(reinterpret_cast<const char*>(&header), sizeof header);
+        out.write(reinterpret_cast<const char*>(cols.data()), static_cast<std::streamsize>(cols.size() * sizeof(std::uint64_t)));
+    });
+}
+
+inline std::vector<SweepRow> read_sweep_columns(const std::filesystem::path& file, SweepFileHeader* header_out = nullptr) {
+    std::ifstream in(file, std::ios::binary);
+    if (!in) throw std::runtime_error("read_sweep_columns: cannot open " + file.string());
+    SweepFileHeader h;
+    in.read(reinterpret_cast<char*>(&h), sizeof h);
+    if (!in || h.magic != SweepFileHeader::magic_value || h.version != SweepFileHeader::version_value
+        || h.header_bytes != sizeof(SweepFileHeader) || h.columns != sweep_columns.size())
+        throw std::runtime_error("read_sweep_columns: " + file.string() + " is not a sweep file of this format version");
+    std::vector<std::uint64_t> cols(sweep_columns.size() * h.points);
+    in.read(reinterpret_cast<char*>(cols.data()), static_cast<std::streamsize>(cols.size() * sizeof(std::uint64_t)));
+    if (!in || in.peek() != std::ifstream::traits_type::eof())
+        throw std::runtime_error("read_sweep_columns: " + file.string() + " is truncated or corrupt");
+    std::vector<SweepRow> rows(h.points);
+    for (std::size_t k = 0; k < rows.size(); ++k) {
+        std::array<std::uint64_t, sweep_columns.size()> w;
+        for (std::size_t c = 0; c < w.size(); ++c) w[c] = cols[c * rows.size() + k];
+        rows[k] = detail::sweep_row(w);
+    }
+    if (header_out) *header_out = h;
+    return rows;
+}
+
+// CSV of the same rows (atomically replaced, like write_sweep_columns).
+inline void write_sweep_csv(const std::filesystem::path& file, const std::vector<SweepRow>& rows) {
+    io::atomic_write_file(file, [&](std::ostream& out) {
+        for (std::size_t c = 0; c < sweep_columns.size(); ++c) out << (c ? "," : "") << sweep_columns[c];
+        out << "\n";
+        out.precision(12);   // exact values are in the columnar file
+        for (const SweepRow& r : rows)
+            out << r.tau_p << ',' << r.tau_q << ',' << r.density << ',' << r.total_size << ',' << r.runs << ','
+                << r.censored << ',' << r.mean << ',' << r.stddev << ',' << r.p50 << ',' << r.p90 << ',' << r.p99 << "\n";
+    });
+}
+
+} // namespace sim
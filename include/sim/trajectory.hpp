@@ -0,0 +1,397 @@
+// trajectory.hpp — compact binary move recorder for selected runs
+//
+// Built only with SCHELLING_RECORD_TRAJECTORIES=1 (see core/config.hpp);
+// otherwise sim.hpp does not include this header and the step hooks vanish.
+//
+// Each recorded move is three LEB128 varints:
+//   (null moves skipped before it) << 1 | color,
+//   zigzag(from - previous move's to),
+//   zigzag(to - from)
+// so a typical move takes 3-6 bytes. A Recorder appends into its own buffer
+// and hands full buffers to the Sink, whose writer thread appends them to the
+// file as blocks; the caller never waits for I/O. File layout (native
+// endianness, 8-byte aligned, readable through mmap by Reader):
+//   FileHeader | { BlockHeader | payload, zero-padded to 8 bytes }*
+// Every block restarts the delta chain, so blocks decode independently.
+// For Checkpointable graphs the Recorder also writes keyframes: state blocks
+// holding the graph's save_state words, one for the initial configuration
+// (step 0, see on_start) and one every keyframe_every moves, right after the
+// moves block it closes. sim/replay.hpp seeks into a recorded run from these
+// keyframes. The FileHeader names the batch (RunParams) the runs came from.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "core/config.hpp"
+#include "sim/graph_concepts.hpp"
+
+namespace sim::trajectory {
+
+// The batch a file's runs belong to: job j's seed and initial configuration
+// follow from these, and tau decides which agents are unhappy.
+struct RunParams {
+    std::uint64_t seed{0};          // master seed the per-job seeds are drawn from
+    std::uint64_t tau_p{0}, tau_q{0};
+    double        density{0.0}, minority{0.0};
+
+    bool operator==(const RunParams&) const = default;
+};
+
+struct FileHeader {
+    static constexpr std::array<char, 8> magic_value{'S', 'C', 'H', 'L', 'T', 'R', 'A', 'J'};
+    static constexpr std::uint32_t version_value = 3;
+
+    std::array<char, 8> magic{magic_value};
+    std::uint32_t version{version_value};
+    std::uint32_t header_bytes{sizeof(FileHeader)};
+    std::uint64_t total_size{0};    // Graph::TotalSize of the recorded runs
+    RunParams     run{};
+};
+
+enum class BlockKind : std::uint64_t {
+    moves = 0,   // varint move records
+    state = 1,   // keyframe: Graph::state_words words, the state at first_step
+};
+
+struct BlockHeader {
+    std::uint64_t job{0};           // job index within the batch
+    std::uint64_t first_step{0};    // moves made in this run before the block
+    std::uint64_t moves{0};         // records in the payload (0 for state blocks)
+    std::uint64_t bytes{0};         // payload bytes (before padding)
+    BlockKind     kind{BlockKind::moves};
+};
+static_assert(sizeof(FileHeader) % 8 == 0 && sizeof(BlockHeader) % 8 == 0);
+
+namespace detail {
+
+inline std::uint8_t* put_varint(std::uint8_t* p, std::uint64_t v) noexcept {
+    while (v >= 0x80) { *p++ = static_cast<std::uint8_t>(v | 0x80); v >>= 7; }
+    *p++ = static_cast<std::uint8_t>(v);
+    return p;
+}
+
+inline const std::uint8_t* get_varint(const std::uint8_t* p, const std::uint8_t* end, std::uint64_t& v) {
+    v = 0;
+    for (unsigned shift = 0; p != end && shift < 64; shift += 7) {
+        const std::uint8_t b = *p++;
+        v |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+        if (!(b & 0x80)) return p;
+    }
+    throw std::runtime_error("trajectory: truncated varint");
+}
+
+inline std::uint64_t zigzag(std::int64_t d) noexcept {
+    return (static_cast<std::uint64_t>(d) << 1) ^ static_cast<std::uint64_t>(d >> 63);
+}
+inline std::int64_t unzigzag(std::uint64_t z) noexcept {
+    return static_cast<std::int64_t>(z >> 1) ^ -static_cast<std::int64_t>(z & 1);
+}
+
+} // namespace detail
+
+// Owns the output file and the writer thread. Thread-safe submit().
+class Sink {
+public:
+    Sink(const std::filesystem::path& file, std::uint64_t total_size, const RunParams& run = {})
+        : file_(std::fopen(file.c_str(), "wb")) {
+        if (!file_) throw std::runtime_error("trajectory: cannot open " + file.string());
+        FileHeader h;
+        h.total_size = total_size;
+        h.run = run;
+        std::fwrite(&h, sizeof h, 1, file_);
+        writer_ = std::thread([this] { write_loop_(); });
+    }
+    Sink(const Sink&) = delete;
+    Sink& operator=(const Sink&) = delete;
+    ~Sink() {
+        {
+            const std::lock_guard lock(mutex_);
+            closing_ = true;
+        }
+        ready_.notify_one();
+        writer_.join();
+        std::fclose(file_);
+    }
+
+    // Queue a block; `payload` is taken and a recycled (empty) buffer returned.
+    std::vector<std::uint8_t> submit(const BlockHeader& h, std::vector<std::uint8_t>&& payload) {
+        std::vector<std::uint8_t> spare;
+        {
+            const std::lock_guard lock(mutex_);
+            queue_.push_back(Pending{h, std::move(payload)});
+            if (!free_.empty()) { spare = std::move(free_.back()); free_.pop_back(); }
+        }
+        ready_.notify_one();
+        spare.clear();
+        return spare;
+    }
+
+private:
+    struct Pending {
+        BlockHeader               header;
+        std::vector<std::uint8_t> payload;
+    };
+
+    void write_loop_() {
+        static constexpr std::uint8_t zeros[8]{};
+        std::unique_lock lock(mutex_);
+        for (;;) {
+            ready_.wait(lock, [&] { return closing_ || !queue_.empty(); });
+            if (queue_.empty()) return;
+            Pending p = std::move(queue_.front());
+            queue_.pop_front();
+            lock.unlock();
+            std::fwrite(&p.header, sizeof p.header, 1, file_);
+            std::fwrite(p.payload.data(), 1, p.payload.size(), file_);
+            std::fwrite(zeros, 1, (8 - p.payload.size() % 8) % 8, file_);
+            p.payload.clear();
+            lock.lock();
+            if (free_.size() < 64) free_.push_back(std::move(p.payload));
+        }
+    }
+
+    std::FILE*                             file_;
+    std::mutex                             mutex_;
+    std::condition_variable                ready_;
+    std::deque<Pending>                    queue_;
+    std::vector<std::vector<std::uint8_t>> free_;
+    bool                                   closing_{false};
+    std::thread                            writer_;
+};
+
+// Encodes one run's moves. Buffers are handed to the Sink at block_bytes,
+// at each keyframe and when the recorder is destroyed.
+class Recorder {
+public:
+    static constexpr std::size_t   block_bytes        = std::size_t{1} << 20;
+    static constexpr std::size_t   max_record         = 3 * 10;   // three 64-bit varints
+    static constexpr std::uint64_t min_keyframe_every = std::uint64_t{1} << 16;
+
+    // Default spacing: 2^16 moves, widened so a keyframe costs at most a
+    // sixth of the moves it follows (3+ bytes each).
+    template <class Graph>
+    static constexpr std::uint64_t default_keyframe_every() noexcept {
+        return std::max<std::uint64_t>(min_keyframe_every, 2 * Graph::state_words * sizeof(std::uint64_t));
+    }
+
+    // keyframe_every 0 picks default_keyframe_every<Graph>().
+    Recorder(Sink& sink, std::uint64_t job, std::uint64_t keyframe_every = 0)
+        : sink_(sink), job_(job), keyframe_every_(keyframe_every) { buf_.resize(block_bytes + max_record); }
+    Recorder(const Recorder&) = delete;
+    Recorder& operator=(const Recorder&) = delete;
+    ~Recorder() { flush_(); }
+
+    // Called once g holds the run's initial configuration: the step-0 keyframe.
+    template <class Graph>
+    void start(const Graph& g) noexcept {
+        if constexpr (Checkpointable<Graph>) keyframe_(g);
+    }
+
+    // Called after the move is applied to g.
+    template <class Graph>
+    void move(const Graph& g, std::uint64_t from, std::uint64_t to, bool color, std::uint64_t skipped) noexcept {
+        move(from, to, color, skipped);
+        if constexpr (Checkpointable<Graph>) {
+            const std::uint64_t every = keyframe_every_ ? keyframe_every_ : default_keyframe_every<Graph>();
+            if (++since_keyframe_ >= every) [[unlikely]] keyframe_(g);
+        }
+    }
+
+    void move(std::uint64_t from, std::uint64_t to, bool color, std::uint64_t skipped) noexcept {
+        std::uint8_t* p = buf_.data() + used_;
+        p = detail::put_varint(p, (skipped << 1) | static_cast<std::uint64_t>(color));
+        p = detail::put_varint(p, detail::zigzag(static_cast<std::int64_t>(from - prev_to_)));
+        p = detail::put_varint(p, detail::zigzag(static_cast<std::int64_t>(to - from)));
+        used_ = static_cast<std::size_t>(p - buf_.data());
+        prev_to_ = to;
+        step_ += skipped + 1;
+        ++moves_;
+        if (used_ >= block_bytes) [[unlikely]] flush_();
+    }
+
+private:
+    template <class Graph>
+    void keyframe_(const Graph& g) noexcept {
+        flush_();
+        since_keyframe_ = 0;
+        constexpr std::size_t bytes = Graph::state_words * sizeof(std::uint64_t);
+        state_.resize(Graph::state_words);
+        g.save_state(state_.data());
+        std::vector<std::uint8_t> payload(bytes);
+        std::memcpy(payload.data(), state_.data(), bytes);
+        (void)sink_.submit(BlockHeader{job_, step_, 0, bytes, BlockKind::state}, std::move(payload));
+    }
+
+    void flush_() noexcept {
+        if (moves_ == 0) return;
+        buf_.resize(used_);
+        buf_ = sink_.submit(BlockHeader{job_, first_step_, moves_, used_}, std::move(buf_));
+        buf_.resize(block_bytes + max_record);
+        used_ = 0;
+        moves_ = 0;
+        prev_to_ = 0;
+        first_step_ = step_;
+    }
+
+    Sink&                     sink_;
+    std::uint64_t             job_;
+    std::vector<std::uint8_t> buf_;
+    std::size_t               used_{0};
+    std::uint64_t             moves_{0};
+    std::uint64_t             prev_to_{0};
+    std::uint64_t             step_{0};
+    std::uint64_t             first_step_{0};
+    std::uint64_t             keyframe_every_;
+    std::uint64_t             since_keyframe_{0};
+    std::vector<std::uint64_t> state_;
+};
+
+// The calling thread's active recorder (nullptr: not recording).
+inline Recorder*& active() noexcept {
+    thread_local Recorder* r = nullptr;
+    return r;
+}
+
+// Hook called by sim::run_schelling_process_until once g is initialized.
+template <class Graph>
+inline void on_start(const Graph& g) noexcept {
+    if (Recorder* r = active()) [[unlikely]] r->start(g);
+}
+
+// Step hook called by sim::schelling_step / schelling_step_skipping once the
+// move is applied to g.
+template <class Graph>
+inline void on_move(const Graph& g, std::uint64_t from, std::uint64_t to, bool color, std::uint64_t skipped) noexcept {
+    if (Recorder* r = active()) [[unlikely]] r->move(g, from, to, color, skipped);
+}
+
+// Records the calling thread's moves into `rec` while in scope.
+class Scope {
+public:
+    explicit Scope(Recorder& rec) noexcept : prev_(active()) { active() = &rec; }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+    ~Scope() { active() = prev_; }
+
+private:
+    Recorder* prev_;
+};
+
+struct Move {
+    std::uint64_t job, step, from, to;   // step: moves (null ones included) before this one
+    bool          color;
+};
+
+// Decoding position inside one block: the moves left and the delta chain.
+struct Cursor {
+    const std::uint8_t* p{nullptr};
+    const std::uint8_t* end{nullptr};
+    std::uint64_t       job{0};
+    std::uint64_t       left{0};      // moves not yet decoded
+    std::uint64_t       step{0};      // step of the last decoded move + 1
+    std::uint64_t       prev_to{0};
+
+    Cursor() = default;
+    Cursor(const BlockHeader& h, const std::uint8_t* payload) noexcept
+        : p(payload), end(payload + h.bytes), job(h.job), left(h.moves), step(h.first_step) {}
+
+    bool done() const noexcept { return left == 0; }
+
+    // Precondition: !done().
+    Move next() {
+        std::uint64_t head, dfrom, dto;
+        p = detail::get_varint(p, end, head);
+        p = detail::get_varint(p, end, dfrom);
+        p = detail::get_varint(p, end, dto);
+        const std::uint64_t from = prev_to + static_cast<std::uint64_t>(detail::unzigzag(dfrom));
+        const std::uint64_t to   = from + static_cast<std::uint64_t>(detail::unzigzag(dto));
+        const Move m{job, step + (head >> 1), from, to, (head & 1) != 0};
+        step = m.step + 1;
+        prev_to = to;
+        --left;
+        return m;
+    }
+};
+
+// Read-only view of a trajectory file (mmap'd).
+class Reader {
+public:
+    using Move = trajectory::Move;
+
+    explicit Reader(const std::filesystem::path& file) {
+        const int fd = ::open(file.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("trajectory: cannot open " + file.string());
+        struct stat st{};
+        if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(FileHeader)) {
+            ::close(fd);
+            throw std::runtime_error("trajectory: " + file.string() + " is too short");
+        }
+        bytes_ = static_cast<std::size_t>(st.st_size);
+        map_ = ::mmap(nullptr, bytes_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (map_ == MAP_FAILED) throw std::runtime_error("trajectory: cannot map " + file.string());
+        std::memcpy(&header_, map_, sizeof header_);
+        if (header_.magic != FileHeader::magic_value || header_.version != FileHeader::version_value
+            || header_.header_bytes != sizeof(FileHeader)) {
+            ::munmap(map_, bytes_);
+            throw std::runtime_error("trajectory: " + file.string() + " is not a trajectory of this format version");
+        }
+    }
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+    ~Reader() { ::munmap(map_, bytes_); }
+
+    const FileHeader& header() const noexcept { return header_; }
+
+    // f(const BlockHeader&, const std::uint8_t* payload) for every block
+    // (moves and state), in file order. Payload pointers stay valid while the
+    // Reader lives and are 8-byte aligned.
+    template <class F>
+    void for_each_block(F&& f) const {
+        const auto* base = static_cast<const std::uint8_t*>(map_);
+        std::size_t off = sizeof(FileHeader);
+        while (off + sizeof(BlockHeader) <= bytes_) {
+            BlockHeader b;
+            std::memcpy(&b, base + off, sizeof b);
+            off += sizeof b;
+            if (b.bytes > bytes_ - off) throw std::runtime_error("trajectory: truncated block");
+            f(static_cast<const BlockHeader&>(b), base + off);
+            off += (b.bytes + 7) / 8 * 8;
+        }
+    }
+
+    // f(const Move&) for every move, block by block in file order (blocks of
+    // concurrently recorded runs interleave; each run's blocks are in order).
+    template <class F>
+    void for_each_move(F&& f) const {
+        for_each_block([&](const BlockHeader& b, const std::uint8_t* payload) {
+            if (b.kind != BlockKind::moves) return;
+            for (Cursor c(b, payload); !c.done();) f(c.next());
+        });
+    }
+
+private:
+    FileHeader  header_{};
+    void*       map_{nullptr};
+    std::size_t bytes_{0};
+};
+
+} // namespace sim::trajectory
@@ -698,7 +698,10 @@ private:
 	{
 		for (const size_type end = PLF_ARRAY_CAPACITY; word_index != end; ++word_index)
 		{
-			const storage_type zero_mask = static_cast<storage_type>(~buffer[word_index]);
+			storage_type zero_mask = static_cast<storage_type>(~buffer[word_index]);
+			// Bits past total_size in the last word are zero (overflow) but not elements
+			if (total_size % PLF_TYPE_BITWIDTH != 0 && word_index == end - 1)
+				zero_mask &= std::numeric_limits<storage_type>::max() >> (PLF_ARRAY_CAPACITY_BITS - total_size);
 			const size_type local_zero_count = std::popcount(zero_mask);
 
 			if (rank < local_zero_count)
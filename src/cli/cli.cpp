@@ -1,8 +1,10 @@
 // cli.cpp — Command-line parsing implementation using cxxopts
 
 #include "cli/cli.hpp"
+#include "sim/placement.hpp"
 
 #include <cxxopts.hpp>
+#include <algorithm>
 #include <charconv>
 #include <cstdlib>
 #include <string>
@@ -10,6 +12,7 @@
 #include <iostream>
 #include <cmath>
 #include <optional>
+#include <vector>
 
 namespace cli {
 static inline std::optional<std::pair<std::uint64_t,std::uint64_t>> parse_pq(std::string_view s) {
@@ -27,6 +30,42 @@ static inline std::optional<std::pair<std::uint64_t,std::uint64_t>> parse_pq(std
     return std::make_pair(p,q);
 }
 
+// Fraction as p/q or decimal (no clamping).
+static inline std::optional<double> parse_fraction(const std::string& s) {
+    if (auto pq = parse_pq(std::string_view(s))) {
+        return static_cast<double>(pq->first) / static_cast<double>(pq->second);
+    }
+    char* endp = nullptr;
+    const double d = std::strtod(s.c_str(), &endp);
+    if (endp && endp != s.c_str() && *endp == '\0') return d;
+    return std::nullopt;
+}
+
+// Threshold as p/q or decimal (a decimal becomes p/10^6, clamped to [0,1]).
+static std::optional<std::pair<std::uint64_t, std::uint64_t>> parse_tau(std::string s) {
+    if (auto pq = parse_pq(std::string_view(s))) return pq;
+    if (!s.empty() && (s.back() == 'f' || s.back() == 'F')) s.pop_back();
+    char* endp = nullptr;
+    const double tau = std::strtod(s.c_str(), &endp);
+    if (!endp || endp == s.c_str() || *endp != '\0') return std::nullopt;
+    if (tau <= 0.0) return std::make_pair(std::uint64_t{0}, std::uint64_t{1});
+    if (tau >= 1.0) return std::make_pair(std::uint64_t{1}, std::uint64_t{1});
+    return std::make_pair(static_cast<std::uint64_t>(std::llround(tau * 1e6)), std::uint64_t{1000000});
+}
+
+// Comma-separated list; nullopt if any item fails to parse.
+template <class T, class Parse>
+static std::optional<std::vector<T>> parse_list(std::string_view s, Parse&& parse) {
+    std::vector<T> out;
+    for (;;) {
+        const std::size_t comma = s.find(',');
+        auto v = parse(std::string(s.substr(0, comma)));
+        if (!v) return std::nullopt;
+        out.push_back(*v);
+        if (comma == std::string_view::npos) return out;
+        s.remove_prefix(comma + 1);
+    }
+}
 
 Options parse_args(int argc, char** argv, bool& want_help, std::string& help_text) {
     Options opt;
@@ -35,7 +74,15 @@ Options parse_args(int argc, char** argv, bool& want_help, std::string& help_tex
     std::string tau_s;        // p/q or decimal
     std::string density_s;    // p/q or decimal for agent density
     double agent_density_val = 0.8; // final parsed value
+    std::string minority_s;   // p/q or decimal for the minority fraction
     std::size_t max_steps_val = 0;  // if present -> set; absent -> ∞
+    double time_limit_val = 0.0;    // if present -> set; absent -> none
+    std::string shard_s;            // i/n
+    std::string cores_s;            // cpulist, e.g. 0-7,16-23
+    std::string record_jobs_s;      // index list, e.g. 0-3,10
+    std::string sweep_tau_s, sweep_density_s, sweep_size_s;   // comma lists
+    std::string jit_sizes_s;        // CS:PL,CS:PL,...
+    std::string jit_types_s;        // type expressions separated by ';'
 
     cxxopts::Options desc("lollipop", "Schelling Lollipop Options");
     // register with defaults where applicable (cxxopts API: spec, desc, value)
@@ -45,61 +92,255 @@ Options parse_args(int argc, char** argv, bool& want_help, std::string& help_tex
         ("clique-size", "Clique size (compiled combos)", cxxopts::value<std::size_t>(opt.clique_size)->default_value("50"))
         ("path-length", "Path length (compiled combos)", cxxopts::value<std::size_t>(opt.path_length)->default_value("450"))
         ("d,agent-density", "Agent density in [0,1] as p/q or decimal", cxxopts::value<std::string>(density_s)->default_value("0.8"))
+        ("minority", "Fraction of agents in the minority color, p/q or decimal (default 1/2)", cxxopts::value<std::string>(minority_s))
         ("e,experiments", "Number of experiments (default 1000)", cxxopts::value<std::size_t>(opt.experiments)->default_value("1000"))
         ("threads", "Number of threads (default: OMP_NUM_THREADS or max)", cxxopts::value<int>(opt.threads)->default_value("0"))
         ("m,max-steps", "Maximum steps per experiment (default ∞)", cxxopts::value<std::size_t>(max_steps_val))
+        ("time-limit", "Wall-clock budget in seconds; running experiments are censored, unstarted ones dropped", cxxopts::value<double>(time_limit_val))
+        ("checkpoint", "Run one experiment, checkpointing its state to FILE (removed once it completes)", cxxopts::value<std::string>(opt.checkpoint_file))
+        ("checkpoint-every", "Seconds between checkpoints (default 600)", cxxopts::value<double>(opt.checkpoint_every)->default_value("600"))
+        ("resume", "Continue from the --checkpoint file if it exists", cxxopts::value<bool>(opt.resume))
+        ("ci-target", "Stop once the relative CI half-width of the mean is <= X; -e becomes the cap", cxxopts::value<double>(opt.ci_target)->default_value("0"))
+        ("ci-z", "Normal quantile of the --ci-target interval (default 1.96, 95%)", cxxopts::value<double>(opt.ci_z)->default_value("1.96"))
+        ("wave", "Experiments between --ci-target checks (default 32)", cxxopts::value<std::size_t>(opt.wave)->default_value("32"))
+        ("cores", "Pin worker threads to these CPUs (cpulist, e.g. 0-7,16-23)", cxxopts::value<std::string>(cores_s))
+        ("numa", "One pinned worker arena per NUMA node (node-local graph memory)", cxxopts::value<bool>(opt.numa))
+        ("heatmap", "Write a step x unhappy-count heatmap of all runs to FILE (PPM)", cxxopts::value<std::string>(opt.heatmap_file))
+        ("heatmap-bins", "Unhappy-count columns of the heatmap (default 256)", cxxopts::value<std::size_t>(opt.heatmap_bins)->default_value("256"))
+        ("heatmap-exact", "Heatmap with one row per step (memory grows with run length; needs -m)", cxxopts::value<bool>(opt.heatmap_exact))
+        ("record", "Record the moves of the --record-jobs experiments to FILE (RECORD=1 builds)", cxxopts::value<std::string>(opt.record_file))
+        ("record-jobs", "Experiment indices to record, e.g. 0-3,10 (default 0)", cxxopts::value<std::string>(record_jobs_s)->default_value("0"))
+        ("replay", "Show experiment --replay-job of a --record FILE at step --at", cxxopts::value<std::string>(opt.replay_file))
+        ("replay-job", "Experiment index for --replay (default 0)", cxxopts::value<std::size_t>(opt.replay_job)->default_value("0"))
+        ("at", "Step for --replay (default 0)", cxxopts::value<std::uint64_t>(opt.replay_at)->default_value("0"))
+        ("sweep-tau", "Sweep: thresholds, comma-separated p/q or decimals (default -t)", cxxopts::value<std::string>(sweep_tau_s))
+        ("sweep-density", "Sweep: agent densities, comma-separated (default -d)", cxxopts::value<std::string>(sweep_density_s))
+        ("sweep-size", "Sweep: lollipop total sizes among the compiled ones (default: this build's)", cxxopts::value<std::string>(sweep_size_s))
+        ("sweep-out", "Sweep: write PREFIX.bin (columnar) and PREFIX.csv", cxxopts::value<std::string>(opt.sweep_out))
+        ("crn", "Sweep: same random numbers for job j at every point; report paired differences", cxxopts::value<bool>(opt.sweep_crn))
+        ("jit-warmup", "Precompile JIT kernels for these lollipop sizes, e.g. 5:45,10:90 (then exit)", cxxopts::value<std::string>(jit_sizes_s))
+        ("jit-type", "Precompile JIT kernels for these graph types, separated by ';'", cxxopts::value<std::string>(jit_types_s))
+        ("jit-header", "Header declaring the --jit-type graphs (default graphs/lollipop.hpp)", cxxopts::value<std::string>(opt.jit_header)->default_value("graphs/lollipop.hpp"))
+        ("jit-size-hint", "Size hint the --jit-type graphs will be run with (default 0)", cxxopts::value<std::uint64_t>(opt.jit_size_hint)->default_value("0"))
+        ("jit-parallel", "Compiler processes at once for the warmup (default: hardware threads)", cxxopts::value<unsigned>(opt.jit_parallel)->default_value("0"))
+        ("shard", "Run only shard i of n (as i/n) of the experiments; needs --partial", cxxopts::value<std::string>(shard_s))
+        ("partial", "Write the batch's partial result to FILE (for --merge)", cxxopts::value<std::string>(opt.partial_file))
+        ("merge", "Merge the partial-result FILEs given as arguments and print the summary", cxxopts::value<bool>(opt.merge))
+        ("files", "Partial-result files for --merge", cxxopts::value<std::vector<std::string>>(opt.merge_files))
     ;
+    desc.parse_positional({"files"});
+    desc.positional_help("[FILE...]");
     help_text = desc.help();
     auto result = desc.parse(argc, argv);
     if (result.count("help")) { want_help = true; return opt; }
 
     // Parse tau: accept p/q or decimal; default to 1/2 if not provided
     if (!tau_s.empty()) {
-        if (auto pq = parse_pq(std::string_view(tau_s))) {
+        if (auto pq = parse_tau(tau_s)) {
             opt.p = pq->first; opt.q = pq->second;
         } else {
-            if (!tau_s.empty() && (tau_s.back()=='f' || tau_s.back()=='F')) tau_s.pop_back();
-            char* endp = nullptr;
-            double tau = std::strtod(tau_s.c_str(), &endp);
-            if (endp && *endp == '\0') {
-                if (tau <= 0.0) { opt.p = 0; opt.q = 1; }
-                else if (tau >= 1.0) { opt.p = 1; opt.q = 1; }
-                else { opt.q = 1000000ULL; opt.p = static_cast<std::uint64_t>(std::llround(tau * static_cast<double>(opt.q))); }
-                if (opt.q == 0) opt.q = 1;
-            } else {
-                std::cerr << "Invalid --tau value; expected p/q or decimal.\n";
-                want_help = true;
-                return opt;
-            }
+            std::cerr << "Invalid --tau value; expected p/q or decimal.\n";
+            want_help = true;
+            return opt;
         }
     }
 
     // Parse agent density: accept p/q or decimal; clamp to [0,1]
     if (!density_s.empty()) {
-        if (auto pq = parse_pq(std::string_view(density_s))) {
-            // convert to double safely
-            agent_density_val = (pq->second == 0) ? 0.0 : static_cast<double>(pq->first) / static_cast<double>(pq->second);
+        if (auto d = parse_fraction(density_s)) {
+            agent_density_val = *d;
         } else {
-            char* endp = nullptr;
-            double d = std::strtod(density_s.c_str(), &endp);
-            if (endp && *endp == '\0') {
-                agent_density_val = d;
-            } else {
-                std::cerr << "Invalid --agent-density; expected p/q or decimal.\n";
-                want_help = true;
-                return opt;
-            }
+            std::cerr << "Invalid --agent-density; expected p/q or decimal.\n";
+            want_help = true;
+            return opt;
         }
     }
-    if (agent_density_val < 0.0) agent_density_val = 0.0;
-    if (agent_density_val > 1.0) agent_density_val = 1.0;
+    agent_density_val = std::clamp(agent_density_val, 0.0, 1.0);
     opt.agent_density = agent_density_val;
 
+    // Minority fraction: same syntax as density; clamp to [0,1]
+    if (result.count("minority")) {
+        if (auto f = parse_fraction(minority_s)) {
+            opt.minority_fraction = std::clamp(*f, 0.0, 1.0);
+        } else {
+            std::cerr << "Invalid --minority; expected p/q or decimal.\n";
+            want_help = true;
+            return opt;
+        }
+    }
+
     // Optional max steps: set only if provided
     if (result.count("max-steps")) {
         opt.max_steps = max_steps_val;
     }
 
+    // Optional batch deadline: must be positive
+    if (result.count("time-limit")) {
+        if (!(time_limit_val > 0.0)) {
+            std::cerr << "Invalid --time-limit; expected a positive number of seconds.\n";
+            want_help = true;
+            return opt;
+        }
+        opt.time_limit = time_limit_val;
+    }
+
+    if (opt.resume && opt.checkpoint_file.empty()) {
+        std::cerr << "--resume requires --checkpoint FILE.\n";
+        want_help = true;
+        return opt;
+    }
+    if (!opt.checkpoint_file.empty() && !opt.partial_file.empty()) {
+        std::cerr << "--partial cannot be combined with --checkpoint (a single run has no batch result).\n";
+        want_help = true;
+        return opt;
+    }
+    if (!shard_s.empty()) {
+        const auto in = parse_pq(std::string_view(shard_s));
+        if (!in || in->first >= in->second) {
+            std::cerr << "Invalid --shard; expected i/n with 0 <= i < n.\n";
+            want_help = true;
+            return opt;
+        }
+        opt.shard_index = static_cast<std::size_t>(in->first);
+        opt.shard_count = static_cast<std::size_t>(in->second);
+        if (opt.partial_file.empty()) {
+            std::cerr << "--shard requires --partial FILE.\n";
+            want_help = true;
+            return opt;
+        }
+    }
+    if (!cores_s.empty()) {
+        auto cpus = sim::parse_cpu_list(cores_s);
+        if (!cpus || cpus->empty()) {
+            std::cerr << "Invalid --cores; expected a CPU list like 0-7,16-23.\n";
+            want_help = true;
+            return opt;
+        }
+        opt.cores = std::move(*cpus);
+    }
+    if (!opt.record_file.empty()) {
+        auto jobs = sim::parse_cpu_list(record_jobs_s);   // same list syntax
+        if (!jobs || jobs->empty()) {
+            std::cerr << "Invalid --record-jobs; expected an index list like 0-3,10.\n";
+            want_help = true;
+            return opt;
+        }
+        opt.record_jobs.assign(jobs->begin(), jobs->end());
+        std::sort(opt.record_jobs.begin(), opt.record_jobs.end());
+        opt.record_jobs.erase(std::unique(opt.record_jobs.begin(), opt.record_jobs.end()), opt.record_jobs.end());
+    }
+    opt.sweep = !sweep_tau_s.empty() || !sweep_density_s.empty() || !sweep_size_s.empty();
+    if (!sweep_tau_s.empty()) {
+        auto taus = parse_list<std::pair<std::uint64_t, std::uint64_t>>(sweep_tau_s, parse_tau);
+        if (!taus) {
+            std::cerr << "Invalid --sweep-tau; expected p/q or decimals separated by commas.\n";
+            want_help = true;
+            return opt;
+        }
+        for (const auto& [p, q] : *taus)
+            opt.sweep_tau.emplace_back(static_cast<core::color_count_t>(p), static_cast<core::color_count_t>(q));
+    }
+    if (!sweep_density_s.empty()) {
+        auto ds = parse_list<double>(sweep_density_s, parse_fraction);
+        if (!ds) {
+            std::cerr << "Invalid --sweep-density; expected p/q or decimals separated by commas.\n";
+            want_help = true;
+            return opt;
+        }
+        for (double d : *ds) opt.sweep_density.push_back(std::clamp(d, 0.0, 1.0));
+    }
+    if (!sweep_size_s.empty()) {
+        auto sizes = parse_list<std::size_t>(sweep_size_s, [](const std::string& t) -> std::optional<std::size_t> {
+            std::size_t v = 0;
+            const auto res = std::from_chars(t.data(), t.data() + t.size(), v);
+            if (res.ec != std::errc{} || res.ptr != t.data() + t.size()) return std::nullopt;
+            return v;
+        });
+        if (!sizes) {
+            std::cerr << "Invalid --sweep-size; expected total sizes separated by commas.\n";
+            want_help = true;
+            return opt;
+        }
+        opt.sweep_size = std::move(*sizes);
+    }
+    if (!jit_sizes_s.empty()) {
+        auto sizes = parse_list<std::pair<std::size_t, std::size_t>>(jit_sizes_s, [](const std::string& t)
+                -> std::optional<std::pair<std::size_t, std::size_t>> {
+            const std::size_t colon = t.find(':');
+            std::size_t cs = 0, pl = 0;
+            if (colon == std::string::npos) return std::nullopt;
+            const char* end = t.data() + t.size();
+            const auto a = std::from_chars(t.data(), t.data() + colon, cs);
+            const auto b = std::from_chars(t.data() + colon + 1, end, pl);
+            if (a.ec != std::errc{} || a.ptr != t.data() + colon || b.ec != std::errc{} || b.ptr != end) return std::nullopt;
+            return std::make_pair(cs, pl);
+        });
+        if (!sizes) {
+            std::cerr << "Invalid --jit-warmup; expected clique:path sizes separated by commas.\n";
+            want_help = true;
+            return opt;
+        }
+        opt.jit_sizes = std::move(*sizes);
+    }
+    for (std::string_view s = jit_types_s; !s.empty();) {
+        const std::size_t semi = s.find(';');
+        if (const std::string_view t = s.substr(0, semi); !t.empty()) opt.jit_types.emplace_back(t);
+        s.remove_prefix(semi == std::string_view::npos ? s.size() : semi + 1);
+    }
+    opt.jit_warmup = !opt.jit_sizes.empty() || !opt.jit_types.empty();
+    if (opt.sweep_crn && !opt.sweep) {
+        std::cerr << "--crn requires a sweep (--sweep-tau, --sweep-density or --sweep-size).\n";
+        want_help = true;
+        return opt;
+    }
+    if (opt.sweep && (opt.ci_target > 0.0 || !opt.heatmap_file.empty() || opt.shard_count > 1 || !opt.partial_file.empty())) {
+        std::cerr << "--sweep-* cannot be combined with --ci-target, --heatmap, --shard or --partial.\n";
+        want_help = true;
+        return opt;
+    }
+    if (!(opt.ci_target >= 0.0) || !(opt.ci_z > 0.0) || opt.wave == 0) {
+        std::cerr << "Invalid --ci-target/--ci-z/--wave; expected X >= 0, z > 0, N >= 1.\n";
+        want_help = true;
+        return opt;
+    }
+    if (opt.heatmap_exact && opt.heatmap_file.empty()) {
+        std::cerr << "--heatmap-exact requires --heatmap FILE.\n";
+        want_help = true;
+        return opt;
+    }
+    // One row per step: without a step budget a single null-move run can
+    // ask for any number of rows.
+    if (opt.heatmap_exact && !opt.max_steps) {
+        std::cerr << "--heatmap-exact requires -m/--max-steps to bound its rows.\n";
+        want_help = true;
+        return opt;
+    }
+    if (opt.heatmap_bins == 0) {
+        std::cerr << "Invalid --heatmap-bins; expected N >= 1.\n";
+        want_help = true;
+        return opt;
+    }
+    if (opt.ci_target > 0.0 && !opt.heatmap_file.empty()) {
+        std::cerr << "--ci-target cannot be combined with --heatmap.\n";
+        want_help = true;
+        return opt;
+    }
+    if (opt.ci_target > 0.0 && opt.shard_count > 1) {
+        std::cerr << "--ci-target cannot be combined with --shard.\n";
+        want_help = true;
+        return opt;
+    }
+    if (opt.merge != !opt.merge_files.empty()) {
+        std::cerr << (opt.merge ? "--merge requires partial-result files.\n" : "Unexpected arguments (did you mean --merge?).\n");
+        want_help = true;
+        return opt;
+    }
+    if (!(opt.checkpoint_every >= 0.0)) {
+        std::cerr << "Invalid --checkpoint-every; expected seconds >= 0.\n";
+        want_help = true;
+        return opt;
+    }
+
     return opt;
 }
 
@@ -1,19 +1,32 @@
 // Main entry: run many Schelling processes on a Lollipop graph and build a heatmap
 #include <cstdint>
 #include <iostream>
+#include <string>
 #include <fstream>
 #include <cstdlib>
 #include <filesystem>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <memory>
+#include <optional>
+#include <vector>
 
 #include <omp.h>
 
 #include "graphs/lollipop.hpp"
 #include "core/rng.hpp"
 #include "core/schelling_threshold.hpp"
-#include "sim/sim.hpp"              // includes run_schelling_process_visit overload
-#include "sim/job_handler.hpp"      // contains run_jobs_heatmap_streamed + to_dense
+#include "sim/sim.hpp"
+#include "sim/job_handler.hpp"      // run_jobs_hitting_time, run_jobs_heatmap
+#include "sim/checkpoint.hpp"
+#include "sim/replay.hpp"
+#include "sim/shard.hpp"
+#include "sim/sweep.hpp"
 #include "cli/cli.hpp"
+#include "io/plot.hpp"
+#include "jit/jit.hpp"
 
 // ---- Build-time graph sizes (override with -DLOLLIPOP_CLIQUE=... -DLOLLIPOP_PATH=...) ----
 #ifndef LOLLIPOP_CLIQUE
@@ -25,17 +38,105 @@
 
 using G = graphs::LollipopGraph<LOLLIPOP_CLIQUE, LOLLIPOP_PATH>;
 
+// Sizes a sweep can use without rebuilding (clique : path = 1 : 9, as in
+// scripts/bench_hitting_time.py).
+using SweepGraphs = sim::GraphList<
+    graphs::LollipopGraph<5, 45>,       graphs::LollipopGraph<10, 90>,       graphs::LollipopGraph<50, 450>,
+    graphs::LollipopGraph<100, 900>,    graphs::LollipopGraph<500, 4500>,    graphs::LollipopGraph<1000, 9000>,
+    graphs::LollipopGraph<5000, 45000>, graphs::LollipopGraph<10000, 90000>, graphs::LollipopGraph<50000, 450000>,
+    graphs::LollipopGraph<100000, 900000>>;
+
+// Ctrl-C asks running experiments to stop; the partial distribution is still printed.
+static std::atomic<bool> g_stop_requested{false};
+extern "C" void on_sigint(int) { g_stop_requested.store(true, std::memory_order_relaxed); }
+
+// Batch summary; `expected` is the number of jobs the batch (or shard) was asked to run.
+static void print_summary(const sim::HittingTimeStats& stats, std::size_t expected) {
+    const auto& settled = stats.settled();
+    std::cout << "Average steps: " << settled.mean() << "\n"
+              << "Std dev: "       << settled.stddev() << "\n"
+              << "Min / max: "     << settled.min() << " / " << settled.max() << "\n"
+              << "p50 / p90 / p99 / p99.9: "
+              << settled.quantile(0.5) << " / " << settled.quantile(0.9) << " / "
+              << settled.quantile(0.99) << " / " << settled.quantile(0.999) << "\n";
+    if (stats.censored_count()) {
+        // Settled-only figures above are biased low; Kaplan-Meier accounts for the censored runs.
+        auto km = [&](double q) {
+            const auto v = stats.km_quantile(q);
+            return v ? std::to_string(*v) : std::string(">budget");
+        };
+        std::cout << "Censored runs: " << stats.censored_count() << " of " << stats.count()
+                  << " (mean unhappy left: " << stats.mean_censored_unhappy() << ")\n"
+                  << "KM p50 / p90 / p99 / p99.9: "
+                  << km(0.5) << " / " << km(0.9) << " / " << km(0.99) << " / " << km(0.999) << "\n";
+    }
+    const std::size_t finished = static_cast<std::size_t>(stats.count() - stats.interrupted_count());
+    if (finished < expected) {
+        std::cout << "Stopped early: " << finished << " of " << expected << " experiments finished";
+        if (stats.interrupted_count())
+            std::cout << ", " << stats.interrupted_count() << " more cut off in flight (counted as censored)";
+        std::cout << "\n";
+    }
+}
+
 int main(int argc, char** argv) {
     // Parse CLI
     bool want_help = false; std::string help_text;
     cli::Options opt = cli::parse_args(argc, argv, want_help, help_text);
     if (want_help) { std::cout << help_text; return 0; }
 
+    // ---- Merge shards written with --shard/--partial ----
+    if (opt.merge) {
+        try {
+            std::vector<sim::PartialResult> parts;
+            for (const auto& f : opt.merge_files) parts.push_back(sim::read_partial(f));
+            const sim::PartialResult merged = sim::merge_partials(parts);
+            if (!opt.partial_file.empty()) sim::write_partial(opt.partial_file, merged);
+            print_summary(merged.stats, static_cast<std::size_t>(merged.header.jobs));
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    // ---- Fill the JIT cache for a grid of specializations ----
+    if (opt.jit_warmup) {
+        std::vector<jit::WarmupEntry> entries;
+        for (const auto& [cs, pl] : opt.jit_sizes) entries.push_back(jit::lollipop_entry(cs, pl));
+        for (const auto& t : opt.jit_types) entries.push_back(jit::WarmupEntry{ opt.jit_header, t, opt.jit_size_hint });
+        const auto t0 = std::chrono::steady_clock::now();
+        const auto results = jit::warmup(entries, opt.jit_parallel);
+        const std::chrono::duration<double> took = std::chrono::steady_clock::now() - t0;
+        std::size_t compiled = 0, cached = 0, failed = 0;
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            const jit::WarmupResult& r = results[i];
+            std::cout << entries[i].graph_type_expr << ": ";
+            if (r.status)      { ++failed;   std::cout << "failed (code " << r.status << ")\n  " << r.log << "\n"; }
+            else if (r.cached) { ++cached;   std::cout << "cached\n"; }
+            else               { ++compiled; std::cout << "compiled in " << r.seconds << " s\n"; }
+        }
+        std::cout << "Warmup: " << compiled << " compiled, " << cached << " cached, " << failed << " failed in "
+                  << took.count() << " s\n";
+        return failed ? 1 : 0;
+    }
+
     // Initialize Schelling threshold (tau defaults to 1/2)
     core::schelling::init_program_threshold(opt.p, opt.q);
 
     // Job handler configuration:
-    sim::JobConfig cfg{ .jobs = opt.experiments, .density = opt.agent_density, .threads = opt.threads };
+    sim::JobConfig cfg{ .jobs = opt.experiments, .density = opt.agent_density, .minority = opt.minority_fraction, .threads = opt.threads };
+    cfg.cancel = &g_stop_requested;
+    if (opt.max_steps) cfg.max_steps = *opt.max_steps;
+    if (opt.time_limit) {
+        cfg.deadline = std::chrono::steady_clock::now()
+                     + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(*opt.time_limit));
+    }
+    cfg.shard = { .index = opt.shard_index, .count = opt.shard_count };
+    cfg.ci_target = opt.ci_target;
+    cfg.ci_z = opt.ci_z;
+    cfg.wave = opt.wave;
+    cfg.placement = { .cores = opt.cores, .per_node = opt.numa };
 
     // Deterministic master RNG (constant seed by default; set SEED env to override)
     std::uint64_t seed = 123456789ULL;
@@ -44,9 +145,181 @@ int main(int argc, char** argv) {
         if (v != 0ULL) seed = static_cast<std::uint64_t>(v);
     }
     core::Xoshiro256ss master_rng(seed);
+    // Stored in --record files; --replay refuses a file recorded with others.
+    const sim::trajectory::RunParams run_params{ .seed = seed, .tau_p = opt.p, .tau_q = opt.q,
+                                                 .density = cfg.density, .minority = sim::minority_share(cfg.minority) };
+#if SCHELLING_RECORD_TRAJECTORIES
+    std::optional<sim::trajectory::Sink> trajectories;   // written out when main returns
+    if (!opt.record_file.empty()) {
+        try {
+            trajectories.emplace(opt.record_file, G::TotalSize, run_params);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+        cfg.trajectories = &*trajectories;
+        cfg.record_jobs = opt.record_jobs;
+    }
+#else
+    if (!opt.record_file.empty()) {
+        std::cerr << "--record needs a build with RECORD=1.\n";
+        return 1;
+    }
+#endif
+    std::signal(SIGINT, on_sigint);
+
+    // ---- Configuration of a recorded experiment at one step ----
+    if (!opt.replay_file.empty()) {
+        try {
+            using ms = std::chrono::duration<double, std::milli>;
+            const auto t0 = std::chrono::steady_clock::now();
+            const sim::trajectory::Reader reader(opt.replay_file);
+            if (reader.header().total_size != G::TotalSize)
+                throw std::runtime_error(opt.replay_file + " was recorded on a graph of another size");
+            const sim::trajectory::RunParams& rec = reader.header().run;
+            if (rec != run_params)
+                throw std::runtime_error(opt.replay_file + " was recorded with SEED=" + std::to_string(rec.seed) + " -t "
+                                         + std::to_string(rec.tau_p) + "/" + std::to_string(rec.tau_q) + " -d "
+                                         + std::to_string(rec.density) + " --minority " + std::to_string(rec.minority)
+                                         + "; replay it with the same settings");
+            auto g = std::make_unique<G>();
+            const sim::Replay<G> replay(reader, opt.replay_job);
+            const auto t1 = std::chrono::steady_clock::now();
+            replay.seek(*g, opt.replay_at);
+            const auto t2 = std::chrono::steady_clock::now();
+            std::cout << "Experiment " << opt.replay_job << " at step " << opt.replay_at << " ("
+                      << (replay.moves() ? "last move at " + std::to_string(replay.end_step() - 1) : std::string("no moves"))
+                      << "): " << g->unhappy_count() << " unhappy agents ("
+                      << ms(t2 - t0).count() << " ms: open " << ms(t1 - t0).count() << ", seek "
+                      << ms(t2 - t1).count() << ", " << replay.keyframes() << " keyframes)\n";
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    // ---- Sweep over a (tau, density, size) grid in one pool ----
+    if (opt.sweep) {
+        auto taus = opt.sweep_tau;
+        if (taus.empty()) taus.emplace_back(opt.p, opt.q);
+        auto densities = opt.sweep_density;
+        if (densities.empty()) densities.push_back(cfg.density);
+        auto sizes = opt.sweep_size;
+        if (sizes.empty()) sizes.push_back(G::TotalSize);
+        std::vector<sim::SweepPoint> points;
+        for (std::size_t n : sizes) {
+            const auto& known = SweepGraphs::total_sizes;
+            const auto it = std::find(known.begin(), known.end(), n);
+            if (it == known.end()) {
+                std::cerr << "Size " << n << " is not compiled in; available:";
+                for (std::size_t k : known) std::cerr << " " << k;
+                std::cerr << "\n";
+                return 1;
+            }
+            for (const auto& [p, q] : taus)
+                for (double d : densities)
+                    points.push_back(sim::SweepPoint{ { p, q }, d, static_cast<std::size_t>(it - known.begin()) });
+        }
+        cfg.common_random_numbers = opt.sweep_crn;
+        std::vector<std::uint64_t> times;
+        const auto stats = sim::run_sweep(SweepGraphs{}, points, cfg, master_rng, opt.sweep_crn ? &times : nullptr);
+        const auto rows  = sim::summarize_sweep(SweepGraphs{}, points, stats);
+        for (const auto& r : rows)
+            std::cout << "tau " << r.tau_p << "/" << r.tau_q << "  density " << r.density << "  size " << r.total_size
+                      << ": mean " << r.mean << "  p50 " << r.p50 << "  runs " << r.runs << "  censored " << r.censored << "\n";
+        // Paired differences against the first point (job j vs job j)
+        for (std::size_t k = 1; opt.sweep_crn && k < points.size(); ++k) {
+            const sim::PairedDiff d = sim::paired_difference(times, std::max<std::size_t>(cfg.jobs, 1), k, 0, cfg.ci_z);
+            std::cout << "point " << k << " - point 0: " << d.mean << " +/- " << d.half_width << " (" << d.pairs
+                      << " pairs; independent runs: +/- " << d.unpaired_half_width << ")\n";
+        }
+        if (!opt.sweep_out.empty()) {
+            try {
+                sim::SweepFileHeader h;
+                h.jobs = std::max<std::size_t>(cfg.jobs, 1);
+                h.seed = seed;
+                h.max_steps = cfg.max_steps;
+                h.minority = sim::minority_share(cfg.minority);
+                sim::write_sweep_columns(opt.sweep_out + ".bin", h, rows);
+                sim::write_sweep_csv(opt.sweep_out + ".csv", rows);
+            } catch (const std::exception& e) {
+                std::cerr << e.what() << "\n";
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    // ---- Single checkpointed run (job 0's seed) ----
+    if (!opt.checkpoint_file.empty()) {
+        core::Xoshiro256ss rng(core::job_seed(core::batch_key(master_rng), 0));
+        auto g = std::make_unique<G>();
+        const sim::CheckpointConfig ck{ .file = opt.checkpoint_file, .interval = std::chrono::duration<double>(opt.checkpoint_every) };
+        auto stop = [&] {
+            return g_stop_requested.load(std::memory_order_relaxed) || std::chrono::steady_clock::now() >= cfg.deadline;
+        };
+        try {
+            const auto r = sim::run_schelling_process_checkpointed(*g, cfg.density, rng, cfg.minority, ck, opt.resume, stop, cfg.max_steps);
+            if (!r)               std::cout << "Interrupted; state saved to " << opt.checkpoint_file << " (rerun with --resume)\n";
+            else if (r->censored) std::cout << "Censored at " << r->steps << " steps with " << r->unhappy << " unhappy agents\n";
+            else                  std::cout << "Steps: " << r->steps << "\n";
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
 
     // ---- Run ----
-    double avg_steps = sim::run_jobs_hitting_time<G>(cfg, master_rng) / static_cast<double>(opt.experiments);
-    std::cout << "Average steps: " << avg_steps << "\n";
+    sim::HittingTimeStats stats;
+    std::size_t J = std::max<std::size_t>(cfg.jobs, 1);
+    if (cfg.ci_target > 0.0) {
+        // Same as a fixed batch of the first r.jobs experiments
+        const sim::SequentialResult r = sim::run_jobs_hitting_time_sequential<G>(cfg, master_rng);
+        stats = r.stats;
+        J = r.jobs;
+        std::cout << (r.converged ? "Converged after " : "Not converged after ") << r.jobs << " of at most " << cfg.jobs
+                  << " experiments (relative CI half-width " << r.rel_half_width << ", target " << cfg.ci_target << ")\n";
+    } else if (opt.heatmap_exact) {
+        sim::StepDenseResult r = sim::run_jobs_step_dense<G>(cfg, master_rng, opt.heatmap_bins);
+        stats = r.stats;
+        if (!io::write_heatmap_ppm(r.heatmap, opt.heatmap_file, 1)) return 1;
+        std::cout << "Heatmap: " << r.heatmap.rows << " steps x " << r.heatmap.bins << " unhappy bins -> " << opt.heatmap_file << "\n";
+    } else if (!opt.heatmap_file.empty()) {
+        const sim::HeatmapResult r = sim::run_jobs_heatmap<G>(cfg, master_rng, opt.heatmap_bins);
+        stats = r.stats;
+        if (!io::write_heatmap_ppm(r.heatmap.to_heatmap(), opt.heatmap_file)) return 1;
+        std::cout << "Heatmap: " << r.heatmap.rows() << " log-step rows x " << r.heatmap.unhappy_bins()
+                  << " unhappy bins (" << r.heatmap.unhappy_width() << " per bin) -> " << opt.heatmap_file << "\n";
+    } else {
+        stats = sim::run_jobs_hitting_time<G>(cfg, master_rng);
+    }
+    if (!opt.partial_file.empty()) {
+        sim::PartialResult part;
+        part.header.total_size  = G::TotalSize;
+        part.header.jobs        = J;
+        part.header.shard_index = cfg.shard.index;
+        part.header.shard_count = cfg.shard.count;
+        part.header.tau_p       = opt.p;
+        part.header.tau_q       = opt.q;
+        part.header.density     = cfg.density;
+        part.header.minority    = sim::minority_share(cfg.minority);
+        part.header.max_steps   = cfg.max_steps;
+        part.header.seed        = seed;
+        part.header.interrupted = stats.interrupted_count();
+        part.header.completed   = stats.count() - part.header.interrupted;
+        part.stats = stats;
+        if (!part.header.complete())
+            std::cerr << "Warning: shard " << cfg.shard.index << " completed " << part.header.completed << " of "
+                      << part.header.expected() << " jobs; --merge will reject " << opt.partial_file << "\n";
+        try {
+            sim::write_partial(opt.partial_file, part);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+    }
+    print_summary(stats, cfg.shard.end(J) - cfg.shard.begin(J));
     return 0;
 }
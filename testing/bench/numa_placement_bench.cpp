@@ -0,0 +1,47 @@
+// Google Benchmark: run_jobs_hitting_time under each worker placement policy
+//
+// Unpinned (TBB default), pinned to all allowed CPUs, and one pinned arena
+// per NUMA node with node-local graph memory. The graph is sized to outgrow
+// the LLC so remote-node traffic shows up; compare jobs/s (items_per_second)
+// across the three on a multi-socket machine. On a single node the per-node
+// policy collapses to one pinned arena and the last two should match.
+// Measured so far only on a 1-CPU, single-node host (13.5, 13.9 and 14.1
+// jobs/s: within noise); the multi-socket gain of --numa is unmeasured.
+#include <benchmark/benchmark.h>
+
+#include "graphs/lollipop.hpp"
+#include "sim/job_handler.hpp"
+#include "sim/placement.hpp"
+#include "core/rng.hpp"
+#include "core/schelling_threshold.hpp"
+
+using BenchGraph = graphs::LollipopGraph<20000, 400000>;
+
+enum class Policy { unpinned, pinned, per_node };
+
+static void BM_HittingTime_Placement(benchmark::State& state) {
+    core::schelling::init_program_threshold(1, 2);
+    const auto policy = static_cast<Policy>(state.range(0));
+    sim::JobConfig cfg{ .jobs = static_cast<std::size_t>(state.range(1)), .density = 0.8 };
+    if (policy == Policy::pinned)   cfg.placement.cores = sim::detail::allowed_cpus();
+    if (policy == Policy::per_node) cfg.placement.per_node = true;
+    state.counters["domains"] = static_cast<double>(sim::make_domains(cfg.placement, cfg.threads).size());
+
+    for (auto _ : state) {
+        core::Xoshiro256ss master(0xC0FFEEULL);
+        const auto stats = sim::run_jobs_hitting_time<BenchGraph>(cfg, master);
+        benchmark::DoNotOptimize(stats.settled().sum());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+
+BENCHMARK(BM_HittingTime_Placement)
+    ->ArgNames({"policy", "jobs"})
+    ->Args({static_cast<long>(Policy::unpinned), 64})
+    ->Args({static_cast<long>(Policy::pinned),   64})
+    ->Args({static_cast<long>(Policy::per_node), 64})
+    ->Iterations(2)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
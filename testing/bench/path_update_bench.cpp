@@ -0,0 +1,40 @@
+// Google Benchmark: Path pop/place cost (unhappy-mask maintenance)
+//
+// Build both variants to compare the word-level refresh against the scalar
+// per-vertex update: `make path_update_bench path_update_bench_scalar`.
+#include <benchmark/benchmark.h>
+#include <memory>
+
+#include "graphs/path.hpp"
+#include "core/bitset.hpp"
+#include "core/rng.hpp"
+#include "core/schelling_threshold.hpp"
+
+template <std::size_t B>
+static void BM_Path_PopPlace(benchmark::State& state) {
+    core::schelling::init_program_threshold(1, 2);
+    core::Xoshiro256ss rng(0x9A7B5EEDULL);
+
+    // ~80% occupied, random colors
+    auto unocc = std::make_unique<core::bitset<B>>();
+    auto col   = std::make_unique<core::bitset<B>>();
+    for (std::size_t i = 0; i < B; ++i) {
+        const std::uint64_t r = rng();
+        if ((r % 5) == 0) unocc->set(i);
+        else if (r & 8)   col->set(i);
+    }
+    auto path = std::make_unique<Path<B>>(*unocc, *col);
+
+    for (auto _ : state) {
+        const auto v = static_cast<core::size_t>(core::uniform_bounded(rng, B));
+        if (path->is_occupied(v)) path->pop_agent(v);
+        else                      path->place_agent(v, rng() & 1);
+        benchmark::DoNotOptimize(path->unhappy_count());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_Path_PopPlace, 450);
+BENCHMARK_TEMPLATE(BM_Path_PopPlace, 900000);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,56 @@
+// Google Benchmark: replica-parallel Path engine vs one-at-a-time Path processes
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "graphs/path.hpp"
+#include "sim/replica_path.hpp"
+#include "sim/sim.hpp"
+#include "core/rng.hpp"
+#include "core/schelling_threshold.hpp"
+
+// Paths can get stuck with an agent that is unhappy wherever it moves; both
+// variants retire a process after this many moves.
+static constexpr std::uint64_t kMaxSteps = 100000;
+
+static constexpr std::uint64_t kBatchKey = 0xBE1CULL;
+
+template <std::size_t B>
+static void BM_Path_Processes_Scalar(benchmark::State& state) {
+    core::schelling::init_program_threshold(1, 2);
+    const auto n = static_cast<std::size_t>(state.range(0));
+    for (auto _ : state) {
+        std::uint64_t total = 0;
+        for (std::size_t j = 0; j < n; ++j) {
+            core::Xoshiro256ss rng(core::job_seed(kBatchKey, j));
+            Path<B> path;
+            sim::initialize_graph(path, 0.8, rng);
+            std::uint64_t t = 0;
+            while (path.unhappy_count() > 0 && t < kMaxSteps) { sim::schelling_step(path, 0.8, rng); ++t; }
+            total += (path.unhappy_count() == 0) ? (t ? t - 1 : 0) : kMaxSteps;
+        }
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <std::size_t B>
+static void BM_Path_Processes_Replicas(benchmark::State& state) {
+    core::schelling::init_program_threshold(1, 2);
+    const auto n = static_cast<std::size_t>(state.range(0));
+    sim::ReplicaPathEngine<B> engine;
+    for (auto _ : state) {
+        std::uint64_t total = 0;
+        engine.run(kBatchKey, 0, n, 0.8, 0.5, [&](std::size_t, const sim::RunResult& r) { total += r.steps; }, kMaxSteps);
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_Path_Processes_Scalar, 20)->Arg(100000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Path_Processes_Replicas, 20)->Arg(100000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Path_Processes_Scalar, 61)->Arg(100000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Path_Processes_Replicas, 61)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
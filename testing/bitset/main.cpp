@@ -5,13 +5,19 @@
 #include "doctest.h"
 
 #define private public
-#include "core/plf_bitset.h"
+#include "third_party/plf_bitset.h"
 #undef private
 
 #include "core/bitset.hpp"
 #include "core/config.hpp"
+#include "core/random_bitset.hpp"
+#include "core/rng.hpp"
+#include "graphs/detail/padded_bitset.hpp"
 
+#include <cmath>
 #include <limits>
+#include <random>
+#include <vector>
 
 namespace {
 	template <std::size_t N>
@@ -65,3 +71,85 @@ TEST_CASE("search_zero_forwards returns max when fully occupied")
 		CHECK(overflow == 0);
 	}
 }
+
+TEST_CASE("PaddedBitset rank directory selects the same indices as the linear scan")
+{
+	constexpr std::size_t bits = 1000;
+	graphs::detail::PaddedBitset<bits, 2, false, false> scan;
+	graphs::detail::PaddedBitset<bits, 2, false, true> indexed;
+	std::mt19937_64 mutate(0x5EEDF00DULL);
+	std::uniform_int_distribution<std::size_t> pos(0, bits - 1);
+
+	for(int it = 0; it < 20000; ++it) {
+		const std::size_t i = pos(mutate);
+		if(mutate() & 1) { scan.set(i); indexed.set(i); }
+		else             { scan.reset(i); indexed.reset(i); }
+		if((it & 7) == 0) { scan.set(-1); indexed.set(-1); } // left padding guard
+		if((it & 7) == 4) { scan.reset(-1); indexed.reset(-1); }
+
+		REQUIRE(scan.count() == indexed.count());
+		std::mt19937_64 a(it), b(it);
+		if(scan.count() > 0) {
+			CHECK(scan.random_setbit_index(a) == indexed.random_setbit_index(b));
+		}
+		if(scan.count() < bits) {
+			CHECK(scan.random_unsetbit_index(a) == indexed.random_unsetbit_index(b));
+		}
+		if(it % 5000 == 4999) { scan.reset(); indexed.reset(); } // full clears keep the directory in sync
+	}
+	indexed.reset();
+	CHECK(indexed.count() == 0);
+	std::mt19937_64 r(1);
+	CHECK(indexed.random_unsetbit_index(r) < bits);
+}
+
+TEST_CASE("random_weight_bitset hits the exact weight and stays in range")
+{
+	core::Xoshiro256ss rng(0x5151);
+	constexpr std::size_t N = 1000;
+	for(std::size_t n : {std::size_t{1}, std::size_t{63}, std::size_t{64}, std::size_t{65}, std::size_t{777}, N}) {
+		for(double frac : {0.0, 0.01, 0.3, 0.5, 0.8, 0.999, 1.0}) {
+			const std::size_t k = static_cast<std::size_t>(frac * static_cast<double>(n));
+			CAPTURE(n); CAPTURE(k);
+			const auto bs = core::random_weight_bitset<N>(n, k, rng);
+			CHECK(bs.count() == k);
+			CHECK(bs.count(n, N) == 0);
+		}
+	}
+}
+
+TEST_CASE("random_weight_bitset_within picks an exact-weight subset of the mask")
+{
+	core::Xoshiro256ss rng(0xC01);
+	constexpr std::size_t N = 517;
+	const auto within = core::random_weight_bitset<N>(N, 300, rng);
+	for(std::size_t k : {std::size_t{0}, std::size_t{1}, std::size_t{90}, std::size_t{150}, std::size_t{299}, std::size_t{300}}) {
+		CAPTURE(k);
+		const auto bs = core::random_weight_bitset_within(within, k, rng);
+		CHECK(bs.count() == k);
+		CHECK((bs & ~within).count() == 0);
+	}
+}
+
+// Every position should be chosen with probability k/n; a biased composition or
+// correction pass shows up as a per-position chi-square far above its n-1 dof.
+TEST_CASE("random_weight_bitset selects every position uniformly")
+{
+	core::Xoshiro256ss rng(0xFA1);
+	constexpr std::size_t n = 150;
+	constexpr int trials = 20000;
+	for(std::size_t k : {std::size_t{7}, std::size_t{75}, std::size_t{140}}) {
+		CAPTURE(k);
+		std::vector<int> hits(n, 0);
+		for(int t = 0; t < trials; ++t) {
+			const auto bs = core::random_weight_bitset<n>(n, k, rng);
+			for(std::size_t i = 0; i < n; ++i) hits[i] += bs.test(i);
+		}
+		const double expect = static_cast<double>(trials) * static_cast<double>(k) / static_cast<double>(n);
+		double chi2 = 0.0;
+		for(int h : hits) chi2 += (h - expect) * (h - expect) / expect;
+		// Positions are negatively correlated (fixed weight), which only shrinks chi2.
+		CAPTURE(chi2);
+		CHECK(chi2 < static_cast<double>(n) + 6.0 * std::sqrt(2.0 * static_cast<double>(n)));
+	}
+}
@@ -0,0 +1,200 @@
+// jit_tests.cpp
+// doctest checks for the JIT's shared-object cache (src/jit/jit.cpp): a
+// second warmup pass and a later load reuse the built .so without running
+// the compiler, concurrent callers of one specialization build it once,
+// concurrent builders of one key (the cross-process lock path) compile once,
+// run_graph_batch applies its step budget and time limit, and concurrent
+// batches in two libraries each run under their own threshold.
+//
+// Each run includes its graph types through a fresh header outside include/
+// (a new cache key), so every compile below really happens; the files it
+// adds to _jit/ are removed at exit. Each compile takes several seconds.
+//
+// Build example:
+//   make -C testing/jit
+//   make -C testing/jit run
+
+#define DOCTEST_CONFIG_IMPLEMENT
+#include "doctest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "jit/jit.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Header declaring the test's graph types; its unique contents give this
+// run its own cache keys.
+const fs::path& test_header() {
+    static const fs::path file = [] {
+        const fs::path dir = fs::temp_directory_path()
+                           / ("schelling_jit_test_" + std::to_string(::getpid()));
+        fs::create_directories(dir);
+        const fs::path f = dir / "jit_test_graphs.hpp";
+        std::ofstream out(f);
+        out << "#pragma once\n"
+            << "#include \"graphs/lollipop.hpp\"\n"
+            << "// jit_tests run " << ::getpid() << " "
+            << std::chrono::steady_clock::now().time_since_epoch().count() << "\n"
+            << "namespace jit_test {\n"
+            << "using Small = graphs::LollipopGraph<3, 4>;\n"
+            << "using Other = graphs::LollipopGraph<4, 5>;\n"
+            << "using Twin  = graphs::LollipopGraph<3, 5>;\n"
+            << "}\n";
+        return f;
+    }();
+    return file;
+}
+
+bool starts_with(const std::string& s, std::string_view prefix) { return s.rfind(prefix, 0) == 0; }
+
+// Remove what this run added to _jit/ and the temp header.
+void clean_up() {
+    std::error_code ec;
+    if (fs::is_directory("_jit", ec))
+        for (const auto& e : fs::directory_iterator("_jit", ec))
+            if (starts_with(e.path().filename().string(), "g_jit_test__")) fs::remove(e.path(), ec);
+    fs::remove_all(test_header().parent_path(), ec);
+}
+
+} // namespace
+
+TEST_CASE("A second warmup pass and a later load reuse the built .so") {
+    const jit::WarmupEntry e{test_header().string(), "jit_test::Small", 7};
+
+    const auto first = jit::warmup({e}, 1);
+    REQUIRE(first.size() == 1);
+    REQUIRE(first[0].status == 0);
+    CHECK_FALSE(first[0].cached);
+    CHECK_FALSE(starts_with(first[0].log, "cached "));
+
+    const auto second = jit::warmup({e}, 1);
+    REQUIRE(second[0].status == 0);
+    CHECK(second[0].cached);
+    REQUIRE(starts_with(second[0].log, "cached "));
+    const fs::path so = second[0].log.substr(7);
+    REQUIRE(fs::exists(so));
+    const auto built = fs::last_write_time(so);
+
+    // First load in this process: from the cache, no compiler run.
+    unsigned long long m1 = 0, u1 = 0, m2 = 0, u2 = 0;
+    std::string log;
+    REQUIRE(jit::run_graph_once(e.include_header, e.graph_type_expr, 1, 2, 0.8, e.max_size_hint, m1, u1, &log) == 0);
+    CHECK(log == "cached " + so.string());
+    // Later calls reuse the loaded library.
+    REQUIRE(jit::run_graph_once(e.include_header, e.graph_type_expr, 1, 2, 0.8, e.max_size_hint, m2, u2, &log) == 0);
+    CHECK(log == "loaded " + so.string());
+    CHECK(m1 == m2);
+    CHECK(u1 == u2);
+    CHECK(fs::last_write_time(so) == built);
+}
+
+TEST_CASE("Concurrent run_graph_once callers build the specialization once") {
+    constexpr std::size_t callers = 4;
+    std::vector<int> rc(callers, -1);
+    std::vector<unsigned long long> moves(callers), unhappy(callers);
+    std::vector<std::string> logs(callers);
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < callers; ++i)
+        threads.emplace_back([&, i] {
+            rc[i] = jit::run_graph_once(test_header().string(), "jit_test::Other", 1, 2, 0.8, 9,
+                                        moves[i], unhappy[i], &logs[i]);
+        });
+    for (auto& t : threads) t.join();
+
+    CHECK(std::count(rc.begin(), rc.end(), 0) == static_cast<std::ptrdiff_t>(callers));
+    const auto compiled = std::count_if(logs.begin(), logs.end(), [](const std::string& l) {
+        return !starts_with(l, "loaded ") && !starts_with(l, "cached ");
+    });
+    const auto loaded = std::count_if(logs.begin(), logs.end(), [](const std::string& l) { return starts_with(l, "loaded "); });
+    CHECK(compiled == 1);
+    CHECK(loaded == static_cast<std::ptrdiff_t>(callers) - 1);
+    CHECK(std::count(moves.begin(), moves.end(), moves[0]) == static_cast<std::ptrdiff_t>(callers));
+}
+
+TEST_CASE("Concurrent builders of one key compile it once") {
+    // Two warmup workers on the same entry take the per-key build lock like
+    // two processes would: one compiles, the other finds the finished .so.
+    const jit::WarmupEntry e{test_header().string(), "jit_test::Twin", 8};
+    const auto r = jit::warmup({e, e}, 2);
+    REQUIRE(r.size() == 2);
+    CHECK(r[0].status == 0);
+    CHECK(r[1].status == 0);
+    CHECK(r[0].cached != r[1].cached);
+    CHECK(starts_with(r[r[0].cached ? 0 : 1].log, "cached "));
+}
+
+TEST_CASE("run_graph_batch honors the step budget and the time limit") {
+    constexpr std::uint64_t none = ~std::uint64_t{0};
+    constexpr std::size_t jobs = 200;
+    std::vector<std::uint64_t> full, capped, late;
+    REQUIRE(jit::run_graph_batch(test_header().string(), "jit_test::Small", 1, 2, 0.8, 7, 42, jobs, 1,
+                                 none, 0.0, full) == 0);
+    REQUIRE(full.size() == jobs);
+    REQUIRE(std::count(full.begin(), full.end(), none) == 0);
+    const std::uint64_t cap = *std::max_element(full.begin(), full.end()) / 2;
+
+    // Jobs past the budget come back censored; the rest are unchanged.
+    REQUIRE(jit::run_graph_batch(test_header().string(), "jit_test::Small", 1, 2, 0.8, 7, 42, jobs, 1,
+                                 cap, 0.0, capped) == 0);
+    bool consistent = true;
+    for (std::size_t j = 0; j < jobs; ++j)
+        consistent = consistent && (capped[j] == full[j] || (capped[j] == none && full[j] >= cap));
+    CHECK(consistent);
+    CHECK(std::count(capped.begin(), capped.end(), none) > 0);
+
+    // A spent time limit stops the batch early instead of running every job.
+    REQUIRE(jit::run_graph_batch(test_header().string(), "jit_test::Small", 1, 2, 0.8, 7, 42, 100000, 1,
+                                 none, 1e-9, late) == 0);
+    CHECK(std::count(late.begin(), late.end(), none) > 0);
+}
+
+TEST_CASE("Concurrent batches in two libraries keep their own thresholds") {
+    // The program-wide threshold is one object shared by every loaded
+    // library; batches must not race on it.
+    constexpr std::uint64_t cap = 100000;
+    constexpr std::size_t jobs = 20000;
+    struct Batch { const char* type; std::uint64_t p, q, hint; std::vector<std::uint64_t> alone, together; };
+    std::vector<Batch> batches{ {"jit_test::Small", 1, 2, 7, {}, {}}, {"jit_test::Other", 2, 3, 9, {}, {}} };
+    for (Batch& b : batches)
+        REQUIRE(jit::run_graph_batch(test_header().string(), b.type, b.p, b.q, 0.8, b.hint, 42, jobs, 2,
+                                     cap, 0.0, b.alone) == 0);
+    for (int round = 0; round < 3; ++round) {
+        std::vector<int> rc(batches.size(), -1);
+        std::vector<std::thread> threads;
+        for (std::size_t i = 0; i < batches.size(); ++i)
+            threads.emplace_back([&, i] {
+                Batch& b = batches[i];
+                rc[i] = jit::run_graph_batch(test_header().string(), b.type, b.p, b.q, 0.8, b.hint, 42, jobs, 2,
+                                             cap, 0.0, b.together);
+            });
+        for (auto& t : threads) t.join();
+        for (std::size_t i = 0; i < batches.size(); ++i) {
+            CAPTURE(batches[i].type);
+            CHECK(rc[i] == 0);
+            CHECK(batches[i].together == batches[i].alone);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    fs::current_path(JIT_TEST_ROOT);
+    doctest::Context ctx;
+    ctx.setOption("abort-after", 5); // stop test execution after 5 failed asserts
+    ctx.applyCommandLine(argc, argv);
+    const int res = ctx.run();
+    clean_up();
+    return res;
+}
@@ -3,6 +3,7 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include "doctest.h"
 
+#include <array>
 #include <cstddef>
 #include <utility>
 #include <optional>
@@ -10,6 +11,14 @@
 #include "core/schelling_threshold.hpp"
 #include "graphs/lollipop.hpp"
 #include "graphs/testing/lollipop_access.hpp"
+#include "core/rng.hpp"
+#include "sim/sim.hpp"
+#include "sim/checkpoint.hpp"
+#include "sim/heatmap.hpp"
+#include "sim/replay.hpp"
+#include "sim/trajectory.hpp"
+#include <filesystem>
+#include <cmath>
 
 namespace {
 using LG = graphs::LollipopGraph<3, 2>;
@@ -498,3 +507,490 @@ TEST_CASE("Scaled random semantic pops/restores preserve unhappy_count (CS=13, P
         }
     }
 }
+
+// -----------------------------------------------------------------------------
+// Null-move fast-forward: hitting-time law matches plain stepping
+// -----------------------------------------------------------------------------
+namespace {
+
+// Hitting time of one run, capped at `cap` so never-settling runs terminate.
+// min(T, cap) has the same law under both step rules when fast-forward is exact.
+template <std::size_t CS, std::size_t PL>
+std::size_t capped_hitting_time(bool skip, std::uint64_t seed, std::size_t cap) {
+    core::Xoshiro256ss rng(seed);
+    graphs::LollipopGraph<CS, PL> g;
+    sim::initialize_graph(g, 0.8, rng);
+    if (g.unhappy_count() == 0) return 0;
+    std::size_t t = 0;
+    if (!skip) {
+        while (sim::schelling_step(g, 0.8, rng) > 0) if (++t >= cap) return cap;
+        return t;
+    }
+    for (;;) {
+        const std::uint64_t s = sim::schelling_step_skipping(g, rng);
+        if (s >= cap - t) return cap;
+        t += static_cast<std::size_t>(s);
+        if (g.unhappy_count() == 0) return t;
+        if (++t >= cap) return cap;
+    }
+}
+
+template <std::size_t CS, std::size_t PL>
+void compare_hitting_time_laws(std::size_t runs, std::size_t cap) {
+    double sum[2]{}, sq[2]{};
+    for (int mode = 0; mode < 2; ++mode) {
+        for (std::size_t r = 0; r < runs; ++r) {
+            const double t = static_cast<double>(capped_hitting_time<CS, PL>(mode == 1, 0xF00D0000ULL + r * 7919 + mode, cap));
+            sum[mode] += t; sq[mode] += t * t;
+        }
+    }
+    const double n = static_cast<double>(runs);
+    const double m0 = sum[0] / n, m1 = sum[1] / n;
+    const double v0 = sq[0] / n - m0 * m0, v1 = sq[1] / n - m1 * m1;
+    const double z = (m1 - m0) / std::sqrt((v0 + v1) / n + 1e-12);
+    CAPTURE(m0); CAPTURE(m1); CAPTURE(z);
+    CHECK(std::fabs(z) < 4.5);
+}
+
+} // namespace
+
+TEST_CASE("Null-move fast-forward preserves the hitting-time law") {
+    set_tau_force(1, 2);
+    compare_hitting_time_laws<13, 17>(4000, 5000);
+    set_tau_force(1, 3); // every run settles; clique-heavy null runs
+    compare_hitting_time_laws<13, 17>(4000, 5000);
+    compare_hitting_time_laws<20, 20>(4000, 5000);
+    set_tau_force(1, 2);
+}
+
+TEST_CASE("bulk_load matches per-agent placement (CS=13, PL=17)") {
+    using LGX = graphs::LollipopGraph<13, 17>;
+    using LAX = graphs::test::LollipopAccess<13, 17>;
+    using Ref = RefLollipop<13, 17>;
+    std::mt19937_64 rng(0xB1C0FFEEULL);
+    std::uniform_int_distribution<int> tri(0, 2);
+    const std::pair<int,int> taus[] = { {0,1}, {1,3}, {1,2}, {2,3}, {1,1} };
+    for (auto [p,q] : taus) {
+        set_tau_force(p, q);
+        for (int it = 0; it < LOLLIPOP_SCALED_STATES; ++it) {
+            Ref ref; ref.clear();
+            LGX g;
+            core::bitset<LGX::TotalSize> occ, col;
+            // Bridge: flat index CS-1
+            const int b = tri(rng);
+            if (b) {
+                const bool c = (b == 2);
+                const auto to = LAX::bridge_index(g); g.place_agent(to, c); ref.place_agent(to, c);
+                occ.set(12); if (c) col.set(12);
+            }
+            std::uniform_int_distribution<std::size_t> occd(0, 12);
+            const std::size_t occ_extra = occd(rng);
+            std::uniform_int_distribution<std::size_t> c1d(0, occ_extra);
+            const std::size_t c1_extra = c1d(rng);
+            for (std::size_t k = 0; k < occ_extra; ++k) {
+                const bool c = k < c1_extra;
+                const auto to = safe_non_bridge_index<13,17>(g); // clique ignores the slot beyond the bridge test
+                g.place_agent(to, c); ref.place_agent(to, c);
+                occ.set(k); if (c) col.set(k);
+            }
+            for (std::size_t j = 0; j < 17; ++j) {
+                const int t = tri(rng);
+                if (t) {
+                    const bool c = (t == 2);
+                    g.place_agent(LGX::PathBase + j, c); ref.place_agent(LGX::PathBase + j, c);
+                    occ.set(LGX::PathBase + j); if (c) col.set(LGX::PathBase + j);
+                }
+            }
+            LGX bulk;
+            bulk.bulk_load(occ, col);
+            CHECK(LAX::c0(bulk) == LAX::c0(g));
+            CHECK(LAX::c1(bulk) == LAX::c1(g));
+            CHECK(LAX::bridge_occ(bulk) == LAX::bridge_occ(g));
+            CHECK(LAX::bridge_color(bulk) == LAX::bridge_color(g));
+            CHECK(LAX::bridge_index(bulk) == LAX::bridge_index(g));
+            CHECK(LAX::path_unhappy(bulk) == LAX::path_unhappy(g));
+            CHECK(bulk.unhappy_count() == ref.unhappy_count());
+        }
+    }
+    set_tau_force(1, 2);
+}
+
+TEST_CASE("Bulk initializer places floor(density*N) agents, half of them color 1") {
+    using LGX = graphs::LollipopGraph<40, 90>;
+    using LAX = graphs::test::LollipopAccess<40, 90>;
+    core::Xoshiro256ss rng(0x1217ULL);
+    for (double density : {0.0, 0.3, 0.8, 1.0}) {
+        const std::size_t K = static_cast<std::size_t>(static_cast<double>(LGX::TotalSize) * density);
+        const auto occ = sim::make_random_occupancy_bitset<LGX>(density, rng);
+        const auto col = sim::make_random_color_bitset(occ, rng);
+        CHECK(occ.count() == K);
+        CHECK(col.count() == K / 2);
+        CHECK((col & ~occ).count() == 0);
+        LGX g;
+        g.bulk_load(occ, col);
+        CHECK(LAX::occ(g) == occ.count(0, 40));
+        CHECK(LAX::c1(g) == col.count(0, 40));
+    }
+}
+
+TEST_CASE("Permuted and rejection initializers honor the minority share") {
+    using LGX = graphs::LollipopGraph<40, 90>;
+    using State = std::array<std::uint64_t, LGX::state_words>;
+    set_tau_force(1, 2);
+    for (sim::Minority minority : {sim::Minority{}, sim::Minority{0.5}, sim::Minority{0.2}}) {
+        // Permuted: the same draws, and so the same configuration, as bulk.
+        core::Xoshiro256ss r1(0x5EED), r2(0x5EED);
+        LGX bulk, permuted;
+        sim::initialize_graph_bulk(bulk, 0.8, r1, minority);
+        sim::initialize_graph_permuted(permuted, 0.8, r2, minority);
+        State a{}, b{};
+        bulk.save_state(a.data());
+        permuted.save_state(b.data());
+        CHECK(a == b);
+
+        // Rejection: floor(K * share) agents of color 1.
+        const core::count_t K = static_cast<core::count_t>(static_cast<double>(LGX::TotalSize) * 0.8);
+        struct Counting : LGX {
+            core::count_t ones = 0;
+            void place_agent(core::size_t i, bool c) { ones += c; LGX::place_agent(i, c); }
+        } rej;
+        core::Xoshiro256ss r3(0x5EED);
+        sim::initialize_graph_rejection(rej, 0.8, r3, minority);
+        CHECK(rej.ones == sim::minority_count(K, sim::minority_share(minority)));
+    }
+}
+
+TEST_CASE("reset() empties the lollipop and allows reuse") {
+    using LGX = graphs::LollipopGraph<13, 17>;
+    using LAX = graphs::test::LollipopAccess<13, 17>;
+    set_tau_force(1, 2);
+    core::Xoshiro256ss rng(0xE5E7ULL);
+    LGX g;
+    for (int round = 0; round < 50; ++round) {
+        g.reset();
+        CHECK(LAX::occ(g) == 0);
+        CHECK_FALSE(LAX::bridge_occ(g));
+        CHECK(g.unhappy_count() == 0);
+        const auto occ = sim::make_random_occupancy_bitset<LGX>(0.7, rng);
+        const auto col = sim::make_random_color_bitset(occ, rng);
+        g.bulk_load(occ, col);
+        LGX fresh;
+        fresh.bulk_load(occ, col);
+        CHECK(g.unhappy_count() == fresh.unhappy_count());
+        CHECK(LAX::path_unhappy(g) == LAX::path_unhappy(fresh));
+        // Mutate so the next reset has real state to clear.
+        for (int s = 0; s < 20 && g.unhappy_count() > 0; ++s) sim::schelling_step(g, 0.7, rng);
+    }
+}
+
+TEST_CASE("run_schelling_process_until: never-stop matches, stop abandons the run") {
+    using LGX = graphs::LollipopGraph<13, 17>;
+    set_tau_force(1, 3); // every run settles
+    for (std::uint64_t seed = 1; seed <= 200; ++seed) {
+        LGX a, b;
+        core::Xoshiro256ss ra(seed), rb(seed);
+        const auto t  = sim::run_schelling_process(a, 0.8, ra);
+        const auto tu = sim::run_schelling_process_until(b, 0.8, rb, 0.5, sim::NeverStop{});
+        REQUIRE(tu.has_value());
+        CHECK_FALSE(tu->censored);
+        CHECK(tu->steps == t);
+    }
+    // A predicate that is always true stops at the first poll; runs that
+    // settle before it still report their hitting time.
+    set_tau_force(1, 2); // long path runs, some never settle
+    std::size_t polls = 0, stopped = 0;
+    for (std::uint64_t seed = 1; seed <= 8; ++seed) {
+        graphs::LollipopGraph<50, 20000> g;
+        core::Xoshiro256ss rng(seed);
+        const auto tu = sim::run_schelling_process_until(g, 0.8, rng, 0.5, [&] { ++polls; return true; });
+        if (!tu) ++stopped;
+    }
+    CAPTURE(stopped);
+    CHECK(polls == stopped);
+    CHECK(stopped > 0);
+}
+
+TEST_CASE("Step budget censors runs at max_steps with their unhappy count") {
+    using LGX = graphs::LollipopGraph<13, 17>;
+    set_tau_force(1, 2);
+    constexpr std::uint64_t cap = 40;
+    std::size_t censored = 0;
+    for (std::uint64_t seed = 1; seed <= 300; ++seed) {
+        LGX g;
+        core::Xoshiro256ss rng(seed);
+        const auto r = sim::run_schelling_process_until(g, 0.8, rng, 0.5, sim::NeverStop{}, cap);
+        REQUIRE(r.has_value());
+        CAPTURE(seed);
+        // Same draws as the capped reference stepping (which also reports
+        // runs with no effective move left as hitting the cap).
+        CHECK((r->censored ? cap : r->steps) == capped_hitting_time<13, 17>(true, seed, cap));
+        if (r->censored) {
+            ++censored;
+            CHECK(r->steps <= cap);
+            CHECK(r->unhappy > 0);
+        } else {
+            CHECK(r->steps < cap);
+            CHECK(r->unhappy == 0);
+            CHECK(g.unhappy_count() == 0);
+        }
+    }
+    CHECK(censored > 0);
+}
+
+TEST_CASE("Checkpointed run resumes to the uninterrupted result") {
+    using LGX = graphs::LollipopGraph<50, 20000>;
+    set_tau_force(1, 2);
+    const auto file = std::filesystem::temp_directory_path() / "schelling_lollipop_test.ckpt";
+    const sim::CheckpointConfig ck{ .file = file, .interval = std::chrono::duration<double>(0.0) };
+    std::size_t resumed = 0;
+    for (std::uint64_t seed = 1; seed <= 8; ++seed) {
+        CAPTURE(seed);
+        std::filesystem::remove(file);
+        auto ref_g = std::make_unique<LGX>();
+        core::Xoshiro256ss ref_rng(seed);
+        const auto ref = sim::run_schelling_process_until(*ref_g, 0.8, ref_rng, 0.5, sim::NeverStop{});
+        REQUIRE(ref.has_value());
+
+        // Interrupt at the first poll (a checkpoint is written at every one).
+        int polls = 0;
+        auto g = std::make_unique<LGX>();
+        core::Xoshiro256ss rng(seed);
+        const auto cut = sim::run_schelling_process_checkpointed(*g, 0.8, rng, 0.5, ck, false, [&] { return ++polls == 1; });
+        if (cut) { CHECK(cut->steps == ref->steps); continue; }   // settled before the cut
+        ++resumed;
+        CHECK(std::filesystem::exists(file));
+
+        // Resume into a fresh graph with an unrelated rng.
+        auto g2 = std::make_unique<LGX>();
+        core::Xoshiro256ss rng2(0xDEAD);
+        const auto res = sim::run_schelling_process_checkpointed(*g2, 0.8, rng2, 0.5, ck, true, sim::NeverStop{});
+        REQUIRE(res.has_value());
+        CHECK(res->steps == ref->steps);
+        CHECK(res->censored == ref->censored);
+        CHECK(rng2() == ref_rng());
+        // A completed run leaves no checkpoint to resume.
+        CHECK_FALSE(std::filesystem::exists(file));
+    }
+    CHECK(resumed > 0);
+
+    // Mismatched graph type and threshold are rejected.
+    graphs::LollipopGraph<13, 17> small;
+    core::Xoshiro256ss rng(1);
+    {
+        auto saved = std::make_unique<LGX>();
+        sim::save_checkpoint(file, *saved, rng, 0);
+    }
+    CHECK_THROWS_AS(sim::load_checkpoint(file, small, rng), std::runtime_error);
+    set_tau_force(1, 3);
+    auto g = std::make_unique<LGX>();
+    CHECK_THROWS_AS(sim::load_checkpoint(file, *g, rng), std::runtime_error);
+    set_tau_force(1, 2);
+    std::filesystem::remove(file);
+}
+
+TEST_CASE("Run observer sees every state once, in order, and fills the heatmap") {
+    using LGX = graphs::LollipopGraph<13, 17>;
+    set_tau_force(1, 2);
+    constexpr std::uint64_t cap = 60;
+    sim::StepHeatmap<> map(LGX::TotalSize, 8);
+    std::uint64_t states = 0;
+    for (std::uint64_t seed = 1; seed <= 200; ++seed) {
+        CAPTURE(seed);
+        LGX a, b;
+        core::Xoshiro256ss ra(seed), rb(seed);
+        std::uint64_t next = 0;
+        core::count_t last = 1;
+        bool ordered = true;
+        const auto r = sim::run_schelling_process_until(a, 0.8, ra, 0.5, sim::NeverStop{}, cap,
+            [&](std::uint64_t t0, std::uint64_t n, core::count_t u) {
+                ordered = ordered && t0 == next && n > 0;
+                next = t0 + n;
+                last = u;
+                map.add(t0, n, u);
+            });
+        // Observing does not change the run.
+        const auto plain = sim::run_schelling_process_until(b, 0.8, rb, 0.5, sim::NeverStop{}, cap);
+        REQUIRE(r.has_value());
+        CHECK(r->steps == plain->steps);
+        CHECK(ordered);
+        if (!r->censored) {
+            CHECK(next == r->steps + 2);   // states after 0 .. steps+1 moves
+            CHECK(last == 0);
+        } else if (r->steps == cap) {
+            CHECK(next == cap);
+        }
+        states += next;
+    }
+    std::uint64_t total = 0;
+    for (std::size_t row = 0; row < map.rows(); ++row)
+        for (std::size_t col = 0; col < map.unhappy_bins(); ++col) total += map.cell(row, col);
+    CHECK(total == states);
+    CHECK(map.rows() == sim::StepHeatmap<>::step_axis::bucket_of(cap - 1) + 1);
+}
+
+TEST_CASE("Recorded trajectories replay to the recorded run") {
+    using LGX = graphs::LollipopGraph<13, 17>;
+    using State = std::array<std::uint64_t, LGX::state_words>;
+    set_tau_force(1, 2);
+    const auto file = std::filesystem::temp_directory_path() / "schelling_lollipop_test.traj";
+    constexpr std::uint64_t runs = 50, cap = 2000;
+    std::vector<sim::RunResult> results;
+    std::vector<State> finals(runs);
+    {
+        sim::trajectory::Sink sink(file, LGX::TotalSize);
+        for (std::uint64_t seed = 1; seed <= runs; ++seed) {
+            sim::trajectory::Recorder rec(sink, seed);
+            const sim::trajectory::Scope scope(rec);
+            LGX g;
+            core::Xoshiro256ss rng(seed);
+            results.push_back(*sim::run_schelling_process_until(g, 0.8, rng, 0.5, sim::NeverStop{}, cap));
+            g.save_state(finals[seed - 1].data());
+        }
+    }
+
+    const sim::trajectory::Reader reader(file);
+    CHECK(reader.header().total_size == LGX::TotalSize);
+    std::vector<std::vector<sim::trajectory::Reader::Move>> moves(runs + 1);
+    reader.for_each_move([&](const sim::trajectory::Reader::Move& m) {
+        REQUIRE(m.job >= 1);
+        REQUIRE(m.job <= runs);
+        moves[m.job].push_back(m);
+    });
+    for (std::uint64_t seed = 1; seed <= runs; ++seed) {
+        CAPTURE(seed);
+        const sim::RunResult& r = results[seed - 1];
+        // Same initial state, then the decoded moves only.
+        LGX g;
+        core::Xoshiro256ss rng(seed);
+        sim::initialize_graph(g, 0.8, rng, 0.5);
+        if (g.unhappy_count() == 0) { CHECK(moves[seed].empty()); continue; }
+        REQUIRE(!moves[seed].empty());
+        bool legal = true;
+        for (const auto& m : moves[seed]) {
+            legal = legal && m.from < LGX::TotalSize && m.to < LGX::TotalSize && m.from != m.to;
+            if (!legal) break;
+            const bool color = g.pop_agent(m.from);
+            legal = color == m.color;
+            g.place_agent(m.to, color);
+        }
+        CHECK(legal);
+        // A censored run's graph may hold one move past the budget (made before
+        // the null run was found to exhaust it); the record has it too.
+        if (!r.censored) {
+            CHECK(moves[seed].back().step == r.steps);
+            CHECK(g.unhappy_count() == 0);
+        }
+        State st{};
+        g.save_state(st.data());
+        CHECK(st == finals[seed - 1]);
+    }
+    std::filesystem::remove(file);
+}
+
+TEST_CASE("Replay seeks match a straight replay at every step") {
+    using LGX = graphs::LollipopGraph<13, 17>;
+    using State = std::array<std::uint64_t, LGX::state_words>;
+    set_tau_force(1, 2);
+    const auto file = std::filesystem::temp_directory_path() / "schelling_lollipop_replay.traj";
+    constexpr std::uint64_t runs = 20, cap = 3000;
+    {
+        sim::trajectory::Sink sink(file, LGX::TotalSize);
+        for (std::uint64_t seed = 1; seed <= runs; ++seed) {
+            sim::trajectory::Recorder rec(sink, seed, 7);
+            const sim::trajectory::Scope scope(rec);
+            LGX g;
+            core::Xoshiro256ss rng(seed);
+            (void)sim::run_schelling_process_until(g, 0.8, rng, 0.5, sim::NeverStop{}, cap);
+        }
+    }
+    const sim::trajectory::Reader reader(file);
+    std::size_t replayed = 0;
+    for (std::uint64_t seed = 1; seed <= runs; ++seed) {
+        CAPTURE(seed);
+        LGX initial;
+        core::Xoshiro256ss rng(seed);
+        sim::initialize_graph(initial, 0.8, rng, 0.5);
+        const sim::Replay<LGX> replay(reader, seed);
+        if (initial.unhappy_count() == 0) {
+            // Settled at the start: no moves, only the step-0 keyframe.
+            CHECK(replay.moves() == 0);
+            LGX h;
+            replay.seek(h, 5);
+            State a{}, b{};
+            initial.save_state(a.data());
+            h.save_state(b.data());
+            CHECK(a == b);
+            continue;
+        }
+        ++replayed;
+        CHECK(replay.keyframes() == replay.moves() / 7 + 1);
+
+        // Reference: the state at every step, from one pass over the moves.
+        std::vector<State> at(replay.end_step() + 1);
+        LGX g;
+        State st{};
+        initial.save_state(st.data());
+        g.load_state(st.data());
+        std::uint64_t t = 0;
+        reader.for_each_move([&](const sim::trajectory::Move& m) {
+            if (m.job != seed) return;
+            for (; t <= m.step; ++t) g.save_state(at[t].data());
+            sim::detail::apply_move(g, m.from, m.to);
+        });
+        for (; t <= replay.end_step(); ++t) g.save_state(at[t].data());
+
+        bool same = true;
+        LGX h;
+        for (std::uint64_t s = replay.end_step() + 2; s-- > 0;) {
+            replay.seek(h, s);
+            h.save_state(st.data());
+            same = same && st == at[std::min(s, replay.end_step())];
+        }
+        CHECK(same);
+
+        // The step-0 keyframe is in the file: a wrong `initial` is never used.
+        const sim::Replay<LGX> blind(reader, seed, LGX{});
+        same = true;
+        for (std::uint64_t s = 0; s <= replay.end_step() + 1; ++s) {
+            blind.seek(h, s);
+            h.save_state(st.data());
+            same = same && st == at[std::min(s, replay.end_step())];
+        }
+        CHECK(same);
+    }
+    CHECK(replayed > 0);
+    std::filesystem::remove(file);
+}
+
+TEST_CASE("Replay without a recorded initial configuration needs one") {
+    using LGX = graphs::LollipopGraph<13, 17>;
+    using State = std::array<std::uint64_t, LGX::state_words>;
+    set_tau_force(1, 2);
+    const auto file = std::filesystem::temp_directory_path() / "schelling_lollipop_unstarted.traj";
+    const sim::trajectory::RunParams run{ .seed = 9, .tau_p = 1, .tau_q = 2, .density = 0.8, .minority = 0.5 };
+    LGX initial, g;
+    core::Xoshiro256ss rng(9);
+    sim::initialize_graph(initial, 0.8, rng, 0.5);
+    REQUIRE(initial.unhappy_count() > 0);
+    State st{};
+    initial.save_state(st.data());
+    g.load_state(st.data());
+    {
+        // Moves recorded by hand: the Recorder is never started.
+        sim::trajectory::Sink sink(file, LGX::TotalSize, run);
+        sim::trajectory::Recorder rec(sink, 0);
+        const sim::trajectory::Scope scope(rec);
+        for (int i = 0; i < 20 && g.unhappy_count(); ++i) (void)sim::schelling_step(g, 0.8, rng);
+    }
+    const sim::trajectory::Reader reader(file);
+    CHECK(reader.header().run == run);
+    CHECK_THROWS_AS(sim::Replay<LGX>(reader, 0), std::runtime_error);
+    const sim::Replay<LGX> replay(reader, 0, initial);
+    LGX h;
+    replay.seek(h, replay.end_step());
+    State a{}, b{};
+    g.save_state(a.data());
+    h.save_state(b.data());
+    CHECK(a == b);
+    std::filesystem::remove(file);
+}
@@ -16,12 +16,15 @@
 #include <cstdint>
 #include <optional>
 #include <random>
+#include <vector>
 
 // Your project headers
 #include "core/bitset.hpp"
 #include "core/schelling_threshold.hpp"
 #include "graphs/path.hpp"
 #include "graphs/testing/path_access.hpp"
+#include "sim/replica_path.hpp"
+#include "sim/sim.hpp"
 
 #ifndef PATH_TEST_STRESS_SCALE
 #define PATH_TEST_STRESS_SCALE 16384
@@ -686,3 +689,171 @@ TEST_CASE("Sentinel + first real neighbor interplay matches Schelling rule acros
         }
     }
 }
+
+// -----------------------------------------------------------------------------
+// Word-level unhappy kernel
+// -----------------------------------------------------------------------------
+
+// Forces τ directly (init_program_threshold is once-only) and checks that
+// the word-local refresh agrees with the per-vertex rule and with a full
+// recompute, including windows that straddle word boundaries.
+template <std::size_t B>
+static void word_kernel_matches_rule(std::uint64_t seed) {
+    const std::pair<int,int> taus[] = {
+        {0,1}, {1,3}, {1,2}, {2,3}, {1,1}
+    };
+    const auto saved = core::schelling::program_threshold;
+    for (auto [p,q] : taus) {
+        CAPTURE(p);
+        CAPTURE(q);
+        core::schelling::program_threshold.p = static_cast<core::color_count_t>(p);
+        core::schelling::program_threshold.q = static_cast<core::color_count_t>(q);
+
+        std::mt19937_64 rng = testutil::make_rng(seed ^ (p * 1315423911ULL) ^ q);
+        core::bitset<B> unocc, colors;
+        testutil::randomize_state(unocc, colors, rng);
+        Path<B> path(unocc, colors);
+        testutil::check_path_consistency(unocc, colors, path);
+
+        std::uniform_int_distribution<std::size_t> pos(0, B - 1);
+        std::bernoulli_distribution coin(0.5);
+        for (std::size_t it = 0; it < 64 * B; ++it) {
+            const std::size_t idx = pos(rng);
+            if (unocc.test(idx)) {
+                const bool c = coin(rng);
+                path.place_agent(idx, c);
+                unocc.reset(idx);
+                if (c) colors.set(idx); else colors.reset(idx);
+            } else {
+                path.pop_agent(idx);
+                unocc.set(idx);
+                colors.reset(idx);
+            }
+        }
+        testutil::check_path_consistency(unocc, colors, path);
+        Path<B> fresh(unocc, colors);
+        CHECK(graphs::test::raw_unhappy_cache(fresh) == graphs::test::raw_unhappy_cache(path));
+    }
+    core::schelling::program_threshold = saved;
+}
+
+TEST_CASE("Word-level unhappy refresh matches per-vertex rule across τ: B=61,190") {
+    word_kernel_matches_rule<61>(0x3141592653ULL);
+    word_kernel_matches_rule<190>(0x2718281828ULL);
+}
+
+TEST_CASE("save_state/load_state round-trip the raw words: B=61,190") {
+    auto check = [](auto tag) {
+        constexpr std::size_t B = decltype(tag)::value;
+        std::mt19937_64 rng = testutil::make_rng(B + 7);
+        core::bitset<B> unocc, colors;
+        testutil::randomize_state(unocc, colors, rng);
+        const Path<B> src(unocc, colors);
+        std::vector<std::uint64_t> words(Path<B>::state_words);
+        src.save_state(words.data());
+        Path<B> dst;
+        dst.set_sentinel(1, 0);   // cleared by load_state
+        dst.load_state(words.data());
+        testutil::check_path_consistency(unocc, colors, dst);
+        CHECK(graphs::test::raw_occ(dst) == graphs::test::raw_occ(src));
+        CHECK(graphs::test::raw_colors(dst) == graphs::test::raw_colors(src));
+        CHECK(graphs::test::raw_unhappy_cache(dst) == graphs::test::raw_unhappy_cache(src));
+    };
+    check(std::integral_constant<std::size_t, 61>{});
+    check(std::integral_constant<std::size_t, 190>{});
+}
+
+// bulk_load from a slice of a wider bitset must land on the same raw layout as
+// the constructor; bits outside the window and colors of vacant cells ignored.
+template <std::size_t B>
+void bulk_load_matches_constructor(std::uint64_t seed) {
+    constexpr std::size_t N = B + 200;
+    std::mt19937_64 rng = testutil::make_rng(seed);
+    std::bernoulli_distribution coin(0.5);
+    for (std::size_t offset : {std::size_t{0}, std::size_t{1}, std::size_t{2}, std::size_t{63}, std::size_t{64}, std::size_t{130}, N - B}) {
+        CAPTURE(offset);
+        core::bitset<B> unocc, colors;
+        testutil::randomize_state(unocc, colors, rng);
+        core::bitset<N> occ_wide, col_wide;
+        for (std::size_t i = 0; i < N; ++i) {
+            const bool inside = i >= offset && i < offset + B;
+            if (inside ? !unocc.test(i - offset) : coin(rng)) occ_wide.set(i);
+            if (inside ? (colors.test(i - offset) || (unocc.test(i - offset) && coin(rng))) : coin(rng)) col_wide.set(i);
+        }
+        Path<B> expect(unocc, colors);
+        Path<B> path;
+        path.bulk_load(occ_wide, col_wide, offset);
+        testutil::check_path_consistency(unocc, colors, path);
+        CHECK(graphs::test::raw_occ(path) == graphs::test::raw_occ(expect));
+        CHECK(graphs::test::raw_colors(path) == graphs::test::raw_colors(expect));
+        CHECK(graphs::test::raw_unhappy_cache(path) == graphs::test::raw_unhappy_cache(expect));
+    }
+}
+
+TEST_CASE("bulk_load matches the bitset constructor at any offset: B=61,190") {
+    bulk_load_matches_constructor<61>(0x5EEDB17ULL);
+    bulk_load_matches_constructor<190>(0xB0A7ULL);
+}
+
+TEST_CASE("reset() restores the default-constructed state: B=61,190") {
+    auto check = [](auto tag) {
+        constexpr std::size_t B = decltype(tag)::value;
+        std::mt19937_64 rng = testutil::make_rng(B);
+        core::bitset<B> unocc, colors;
+        testutil::randomize_state(unocc, colors, rng);
+        Path<B> path(unocc, colors);
+        path.set_sentinel(1, 1);
+        path.reset();
+        const Path<B> fresh;
+        CHECK(graphs::test::raw_occ(path) == graphs::test::raw_occ(fresh));
+        CHECK(graphs::test::raw_colors(path) == graphs::test::raw_colors(fresh));
+        CHECK(graphs::test::raw_unhappy_cache(path) == graphs::test::raw_unhappy_cache(fresh));
+        CHECK(path.count_by_color(std::nullopt) == B);
+        CHECK(path.unhappy_count() == 0);
+        // Still fully usable after reset.
+        testutil::randomize_state(unocc, colors, rng);
+        for (std::size_t i = 0; i < B; ++i) if (!unocc.test(i)) path.place_agent(i, colors.test(i));
+        testutil::check_path_consistency(unocc, colors, path);
+    };
+    check(std::integral_constant<std::size_t, 61>{});
+    check(std::integral_constant<std::size_t, 190>{});
+}
+
+// Replica engine: every job must reproduce the scalar process exactly (same
+// seed, same draws), whatever the lane count and refill order. Jobs start at
+// a non-zero index, as in a TBB chunk.
+template <std::size_t B, std::size_t Lanes>
+void replica_engine_matches_scalar(double density, double minority, std::size_t jobs,
+                                   std::uint64_t max_steps = ~std::uint64_t{0}) {
+    constexpr std::uint64_t key = 0xABCD0000ULL;
+    constexpr std::size_t first = 7;
+    std::vector<sim::RunResult> got(jobs, sim::RunResult{~std::uint64_t{0}, 0, false});
+    sim::ReplicaPathEngine<B, Lanes> engine;
+    engine.run(key, first, jobs, density, minority,
+               [&](std::size_t j, const sim::RunResult& r) { got[j - first] = r; }, max_steps);
+    for (std::size_t j = 0; j < jobs; ++j) {
+        core::Xoshiro256ss rng(core::job_seed(key, first + j));
+        Path<B> path;
+        const auto expect = sim::run_schelling_process_until(path, density, rng, minority, sim::NeverStop{}, max_steps);
+        CAPTURE(j);
+        REQUIRE(expect.has_value());
+        CHECK(got[j].steps == expect->steps);
+        CHECK(got[j].censored == expect->censored);
+        CHECK(got[j].unhappy == expect->unhappy);
+    }
+}
+
+TEST_CASE("Replica engine reproduces scalar Path hitting times: B=20,61") {
+    const std::pair<int,int> taus[] = { {1,3}, {1,2}, {2,3} };
+    const auto saved = core::schelling::program_threshold;
+    for (auto [p,q] : taus) {
+        CAPTURE(p); CAPTURE(q);
+        core::schelling::program_threshold.p = static_cast<core::color_count_t>(p);
+        core::schelling::program_threshold.q = static_cast<core::color_count_t>(q);
+        replica_engine_matches_scalar<20, 8>(0.7, 0.5, 300);
+        replica_engine_matches_scalar<61, 64>(0.8, 0.5, 300);
+        replica_engine_matches_scalar<61, 3>(0.6, 0.3, 100);
+        replica_engine_matches_scalar<61, 64>(0.8, 0.5, 300, 15);   // censored runs too
+    }
+    core::schelling::program_threshold = saved;
+}
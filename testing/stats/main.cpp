@@ -0,0 +1,634 @@
+// stats_tests.cpp
+// doctest checks for sim::LogHistogram (bucket layout, quantile error bound,
+// streaming moments, merge equivalence), HittingTimeStats' Kaplan-Meier
+// estimate under censoring, the shard partial-result format, and the
+// fixed-memory step x unhappy heatmap, the flat StepDense arena, and the
+// parameter sweep runner and its columnar output.
+//
+// Build example:
+//   make -C testing/stats
+//   make -C testing/stats run
+
+#define DOCTEST_CONFIG_IMPLEMENT
+#include "doctest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <tbb/global_control.h>
+
+#include "io/atomic_file.hpp"
+#include "sim/heatmap.hpp"
+#include "sim/hitting_stats.hpp"
+#include "sim/placement.hpp"
+#include "sim/shard.hpp"
+#include "sim/step_dense.hpp"
+#include "sim/sweep.hpp"
+#include "graphs/lollipop.hpp"
+#include "core/rng.hpp"
+
+using Hist = sim::HittingTimeStats::histogram;
+
+namespace testutil {
+
+// Heavy-tailed samples spanning many octaves, like hitting times.
+inline std::vector<std::uint64_t> sample_values(std::size_t n, std::uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::lognormal_distribution<double> d(8.0, 2.5);
+    std::vector<std::uint64_t> v(n);
+    for (auto& x : v) x = static_cast<std::uint64_t>(d(rng));
+    return v;
+}
+
+} // namespace testutil
+
+TEST_CASE("bucket layout is contiguous and monotone") {
+    CHECK(Hist::bucket_of(0) == 0);
+    CHECK(Hist::bucket_of(Hist::sub_count - 1) == Hist::sub_count - 1);
+    for (std::size_t i = 0; i + 1 < Hist::bucket_count; ++i) {
+        REQUIRE(Hist::bucket_low(i) <= Hist::bucket_high(i));
+        REQUIRE(Hist::bucket_high(i) + 1 == Hist::bucket_low(i + 1));
+        REQUIRE(Hist::bucket_of(Hist::bucket_low(i)) == i);
+        REQUIRE(Hist::bucket_of(Hist::bucket_high(i)) == i);
+    }
+    CHECK(Hist::bucket_of(~std::uint64_t{0}) == Hist::bucket_count - 1);
+}
+
+TEST_CASE("quantiles stay within the bucket relative error") {
+    auto v = testutil::sample_values(200000, 0x5EED);
+    Hist h;
+    for (auto x : v) h.record(x);
+    std::sort(v.begin(), v.end());
+    CHECK(h.count() == v.size());
+    CHECK(h.min() == v.front());
+    CHECK(h.max() == v.back());
+
+    const double rel = 1.0 / static_cast<double>(Hist::sub_count);
+    for (double q : {0.0, 0.1, 0.5, 0.9, 0.99, 0.999, 1.0}) {
+        const std::size_t rank = std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil(q * v.size())));
+        const double exact = static_cast<double>(v[rank - 1]);
+        const double got   = static_cast<double>(h.quantile(q));
+        CHECK(got >= exact);
+        CHECK(got <= exact * (1.0 + rel) + 1.0);
+    }
+}
+
+TEST_CASE("streaming moments match a two-pass computation") {
+    const auto v = testutil::sample_values(50000, 0xABCD);
+    Hist h;
+    long double s = 0;
+    std::uint64_t sum = 0;
+    for (auto x : v) { h.record(x); s += x; sum += x; }
+    const long double mean = s / v.size();
+    long double ss = 0;
+    for (auto x : v) ss += (x - mean) * (x - mean);
+    const double var = static_cast<double>(ss / (v.size() - 1));
+
+    CHECK(h.sum() == sum);
+    CHECK(h.mean() == doctest::Approx(static_cast<double>(mean)).epsilon(1e-9));
+    CHECK(h.variance() == doctest::Approx(var).epsilon(1e-9));
+}
+
+TEST_CASE("merge equals recording everything into one histogram") {
+    const auto v = testutil::sample_values(30000, 0x1234);
+    Hist all;
+    for (auto x : v) all.record(x);
+
+    // Uneven split into parts, merged in a tree like parallel_reduce would.
+    Hist a, b, c, empty;
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        if (i < 100) a.record(v[i]);
+        else if (i < 20000) b.record(v[i]);
+        else c.record(v[i]);
+    }
+    b.merge(c);
+    b.merge(empty);
+    a.merge(b);
+
+    CHECK(a.count() == all.count());
+    CHECK(a.sum() == all.sum());
+    CHECK(a.min() == all.min());
+    CHECK(a.max() == all.max());
+    CHECK(a.mean() == all.mean());           // exact integer moments: merge order is irrelevant
+    CHECK(a.variance() == all.variance());
+    for (std::size_t i = 0; i < Hist::bucket_count; ++i) REQUIRE(a.bucket(i) == all.bucket(i));
+    for (double q : {0.5, 0.99, 0.999}) CHECK(a.quantile(q) == all.quantile(q));
+}
+
+TEST_CASE("Kaplan-Meier without censoring reduces to the empirical distribution") {
+    const auto v = testutil::sample_values(20000, 0x77);
+    sim::HittingTimeStats st;
+    for (auto x : v) st.record(x);
+    for (double q : {0.0, 0.25, 0.5, 0.9, 0.99, 0.999, 1.0}) {
+        REQUIRE(st.km_quantile(q).has_value());
+        CHECK(*st.km_quantile(q) == st.settled().quantile(q));
+    }
+    CHECK(st.survival(st.settled().max()) == doctest::Approx(0.0));
+    CHECK(st.survival(0) == doctest::Approx(1.0 - double(std::count(v.begin(), v.end(), 0u)) / v.size()));
+}
+
+TEST_CASE("Kaplan-Meier with censoring matches the product-limit estimate") {
+    // Small exact values (one bucket each): events at 1,2,2,4,6; censored at 3,5,5.
+    sim::HittingTimeStats st;
+    for (std::uint64_t t : {1, 2, 2, 4, 6}) st.record(t);
+    st.record_censored(3, 7);
+    st.record_censored(5, 2);
+    st.record_censored(5, 3);
+    CHECK(st.count() == 8);
+    CHECK(st.censored_count() == 3);
+    CHECK(st.mean_censored_unhappy() == doctest::Approx(4.0));
+
+    // At risk: t=1:8, t=2:7, t=4:4, t=6:1.
+    const double s1 = 7.0 / 8, s2 = s1 * 5.0 / 7, s4 = s2 * 3.0 / 4, s6 = 0.0;
+    CHECK(st.survival(0) == doctest::Approx(1.0));
+    CHECK(st.survival(1) == doctest::Approx(s1));
+    CHECK(st.survival(3) == doctest::Approx(s2));
+    CHECK(st.survival(4) == doctest::Approx(s4));
+    CHECK(st.survival(5) == doctest::Approx(s4));
+    CHECK(st.survival(6) == doctest::Approx(s6));
+    CHECK(*st.km_quantile(0.3) == 2);   // S(2) = 0.625 <= 0.7
+    CHECK(*st.km_quantile(0.5) == 4);   // S(4) = 0.46875 <= 0.5
+    CHECK(*st.km_quantile(0.6) == 6);   // S(4) > 0.4, S(6) = 0
+}
+
+TEST_CASE("quantiles beyond the censoring horizon are undetermined") {
+    sim::HittingTimeStats st;
+    for (std::uint64_t t = 0; t < 40; ++t) st.record(t);
+    for (int i = 0; i < 60; ++i) st.record_censored(100, 1);
+    CHECK(st.km_quantile(0.3).has_value());
+    CHECK_FALSE(st.km_quantile(0.5).has_value());
+    CHECK(st.survival(1000) == doctest::Approx(0.6));
+
+    sim::HittingTimeStats none;
+    CHECK_FALSE(none.km_quantile(0.5).has_value());
+    none.merge(st);
+    CHECK(none.count() == st.count());
+    CHECK(none.survival(10) == doctest::Approx(st.survival(10)));
+}
+
+TEST_CASE("relative CI half-width shrinks like 1/sqrt(n)") {
+    Hist h;
+    CHECK(sim::relative_ci_half_width(h, 1.96) == std::numeric_limits<double>::infinity());
+    h.record(10);
+    CHECK(sim::relative_ci_half_width(h, 1.96) == std::numeric_limits<double>::infinity());
+    h.record(30);   // mean 20, s = sqrt(200)
+    CHECK(sim::relative_ci_half_width(h, 2.0) == doctest::Approx(2.0 * std::sqrt(200.0) / std::sqrt(2.0) / 20.0));
+
+    const auto v = testutil::sample_values(40000, 0x5151);
+    Hist a, b;
+    for (std::size_t i = 0; i < v.size(); ++i) { if (i < 10000) a.record(v[i]); b.record(v[i]); }
+    const double ratio = sim::relative_ci_half_width(a, 1.96) / sim::relative_ci_half_width(b, 1.96);
+    CHECK(ratio == doctest::Approx(2.0).epsilon(0.25));
+}
+
+TEST_CASE("serialized stats round-trip and equal stats write equal bytes") {
+    const auto v = testutil::sample_values(5000, 0x99);
+    sim::HittingTimeStats a, b1, b2;
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        a.record(v[i]);
+        (i % 3 ? b1 : b2).record(v[i]);
+        if (i % 50 == 0) { a.record_censored(v[i], i); (i % 3 ? b2 : b1).record_censored(v[i], i); }
+    }
+    b2.merge(b1);
+
+    std::ostringstream oa, ob;
+    a.write(oa);
+    b2.write(ob);
+    CHECK(oa.str() == ob.str());
+
+    std::istringstream in(oa.str());
+    sim::HittingTimeStats r;
+    REQUIRE(r.read(in));
+    std::ostringstream orr;
+    r.write(orr);
+    CHECK(orr.str() == oa.str());
+    CHECK(r.settled().variance() == a.settled().variance());
+    CHECK(r.mean_censored_unhappy() == a.mean_censored_unhappy());
+
+    std::istringstream shorter(oa.str().substr(0, oa.str().size() - 1));
+    CHECK_FALSE(sim::HittingTimeStats{}.read(shorter));
+}
+
+TEST_CASE("atomic_write_file replaces whole files and keeps the old one on failure") {
+    const auto file = std::filesystem::temp_directory_path() / "schelling_stats_atomic.bin";
+    const std::string big(200'000, 'x');   // several streambuf flushes
+    io::atomic_write_file(file, [&](std::ostream& out) { out << big; });
+    CHECK(std::filesystem::file_size(file) == big.size());
+    CHECK_THROWS_AS(io::atomic_write_file(file, [](std::ostream& out) {
+        out << "partial";
+        throw std::runtime_error("fill failed");
+    }), std::runtime_error);
+    CHECK(std::filesystem::file_size(file) == big.size());
+    CHECK_FALSE(std::filesystem::exists(std::filesystem::path(file) += ".tmp"));
+    std::filesystem::remove(file);
+}
+
+TEST_CASE("shard ranges partition the jobs") {
+    for (std::size_t J : {1u, 7u, 100u, 1001u}) {
+        for (std::size_t n : {1u, 2u, 3u, 8u}) {
+            std::size_t next = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                const sim::ShardSpec s{ .index = i, .count = n };
+                REQUIRE(s.begin(J) == next);
+                REQUIRE(s.end(J) >= s.begin(J));
+                next = s.end(J);
+            }
+            CHECK(next == J);
+        }
+    }
+}
+
+TEST_CASE("merge_partials checks coverage and batch identity") {
+    const auto v = testutil::sample_values(3000, 0x42);
+    sim::PartialResult whole;
+    whole.header.jobs = v.size();
+    std::vector<sim::PartialResult> parts(3);
+    for (std::size_t i = 0; i < 3; ++i) {
+        parts[i].header = whole.header;
+        parts[i].header.shard_index = i;
+        parts[i].header.shard_count = 3;
+        const sim::ShardSpec s{ .index = i, .count = 3 };
+        for (std::size_t j = s.begin(v.size()); j < s.end(v.size()); ++j) parts[i].stats.record(v[j]);
+        parts[i].header.completed = parts[i].stats.count();
+        CHECK(parts[i].header.complete());
+    }
+    for (auto x : v) whole.stats.record(x);
+
+    std::swap(parts[0], parts[2]);
+    const auto merged = sim::merge_partials(parts);
+    CHECK(merged.header.shard_count == 1);
+    std::ostringstream om, ow;
+    merged.stats.write(om);
+    whole.stats.write(ow);
+    CHECK(om.str() == ow.str());
+
+    auto dup = parts;
+    dup[1] = dup[0];
+    CHECK_THROWS(sim::merge_partials(dup));
+    auto missing = parts;
+    missing.pop_back();
+    CHECK_THROWS(sim::merge_partials(missing));
+    auto foreign = parts;
+    foreign[2].header.seed = 1;
+    CHECK_THROWS(sim::merge_partials(foreign));
+
+    // A shard stopped early (fewer jobs, or some cut off in flight) does not merge.
+    auto short_run = parts;
+    short_run[1].header.completed -= 1;
+    CHECK_FALSE(short_run[1].header.complete());
+    CHECK_THROWS(sim::merge_partials(short_run));
+    auto cut_off = parts;
+    cut_off[1].header.completed -= 1;
+    cut_off[1].header.interrupted = 1;
+    CHECK_THROWS(sim::merge_partials(cut_off));
+}
+
+TEST_CASE("StepHeatmap splits step ranges across log rows in fixed memory") {
+    using Map = sim::StepHeatmap<2>;   // exact rows 0..3, then 4 rows per octave
+    Map m(1000, 10);                   // 101 per unhappy bin -> 10 bins
+    CHECK(m.unhappy_width() == 101);
+    CHECK(m.unhappy_bins() == 10);
+
+    m.add(0, 20, 500);                 // steps 0..19, bin 4
+    CHECK(m.rows() == Map::step_axis::bucket_of(19) + 1);
+    std::uint64_t sum = 0;
+    for (std::size_t r = 0; r < m.rows(); ++r) {
+        sum += m.cell(r, 4);
+        CHECK(m.cell(r, 4) == Map::step_axis::bucket_high(r) - Map::step_axis::bucket_low(r) + 1);
+    }
+    CHECK(sum == 20);
+
+    // A run of 2^40 null moves costs O(rows), not O(steps).
+    Map big(1000, 10);
+    big.add(1, std::uint64_t{1} << 40, 1000);
+    std::uint64_t big_sum = 0;
+    for (std::size_t r = 0; r < big.rows(); ++r) big_sum += big.cell(r, 9);
+    CHECK(big_sum == std::uint64_t{1} << 40);
+
+    m.merge(big);
+    CHECK(m.rows() == big.rows());
+    CHECK(m.cell(0, 4) == 1);
+    CHECK(m.cell(1, 9) == 1);
+
+    // per_step scaling: every full row of a single constant run is flat.
+    Map flat(7, 8);
+    flat.add(0, 32, 3);
+    const auto hm = flat.to_heatmap();
+    REQUIRE(hm.rows == flat.rows());
+    for (std::size_t r = 0; r < hm.rows; ++r) CHECK(hm.data[r * hm.bins + 3] == hm.data[3]);
+}
+
+TEST_CASE("StepDense: observer rows, tree reduction and zero-copy handoff") {
+    // Part p observes steps [p, p+3p] at unhappy value p (width 2 -> column p/2).
+    constexpr std::size_t P = 13, bins = 8;
+    std::vector<sim::StepDense> parts;
+    sim::StepDense serial(bins, 2);
+    for (std::size_t p = 0; p < P; ++p) {
+        sim::StepDense d(bins, 2);
+        d(p, 3 * p + 1, static_cast<core::count_t>(p));
+        serial.merge(d);
+        parts.push_back(std::move(d));
+    }
+    CHECK(serial.rows() == 4 * (P - 1) + 1);
+    CHECK(serial.row(0)[0] == 1);
+    CHECK(serial.row(4 * (P - 1))[6] == 1);          // unhappy 12 -> column 6
+    sim::StepDense clamp(bins, 2);
+    clamp(0, 1, 100);                                  // past the last column
+    CHECK(clamp.row(0)[bins - 1] == 1);
+    sim::StepDense wider(bins + 1, 2), coarser(bins, 4);
+    wider(0, 1, 0);
+    coarser(0, 1, 0);
+    CHECK_THROWS_AS(clamp.merge(wider), std::invalid_argument);
+    CHECK_THROWS_AS(clamp.merge(coarser), std::invalid_argument);
+
+    sim::StepDense tree = sim::reduce_step_dense(parts);
+    REQUIRE(tree.rows() == serial.rows());
+    for (std::size_t r = 0; r < tree.rows(); ++r)
+        for (std::size_t c = 0; c < bins; ++c) REQUIRE(tree.row(r)[c] == serial.row(r)[c]);
+
+    const std::uint64_t* arena = tree.row(0);
+    const std::size_t rows = tree.rows();
+    const sim::Heatmap hm = std::move(tree).to_heatmap();
+    CHECK(hm.rows == rows);
+    CHECK(hm.bins == bins);
+    CHECK(hm.data.data() == arena);
+    CHECK(hm.data.size() == rows * bins);
+}
+
+TEST_CASE("run_jobs_hitting_time_sequential stops at the same job at any thread count") {
+    using G = graphs::LollipopGraph<10, 90>;
+    const tbb::global_control workers(tbb::global_control::max_allowed_parallelism, 4);
+    sim::JobConfig cfg{ .jobs = 100'000, .threads = 1 };
+    cfg.ci_target = 0.02;
+    cfg.wave = 16;
+    auto run = [&](int threads) {
+        cfg.threads = threads;
+        core::Xoshiro256ss master(21);
+        return sim::run_jobs_hitting_time_sequential<G>(cfg, master);
+    };
+    const sim::SequentialResult one = run(1), four = run(4);
+    REQUIRE(one.converged);
+    CHECK(one.jobs % cfg.wave == 0);
+    CHECK(one.jobs < cfg.jobs);
+    CHECK(four.converged);
+    CHECK(four.jobs == one.jobs);
+    CHECK(four.rel_half_width == one.rel_half_width);
+
+    sim::JobConfig fixed{ .jobs = one.jobs, .threads = 4 };
+    core::Xoshiro256ss master(21);
+    const auto batch = sim::run_jobs_hitting_time<G>(fixed, master);
+    std::ostringstream a, b, c;
+    one.stats.write(a);
+    four.stats.write(b);
+    batch.write(c);
+    CHECK(a.str() == b.str());
+    CHECK(a.str() == c.str());
+}
+
+TEST_CASE("parse_cpu_list reads Linux cpulists") {
+    CHECK(sim::parse_cpu_list("0-3,8,10-11\n") == std::vector<int>{0, 1, 2, 3, 8, 10, 11});
+    CHECK(sim::parse_cpu_list("5") == std::vector<int>{5});
+    CHECK(sim::parse_cpu_list("") == std::vector<int>{});
+    CHECK_FALSE(sim::parse_cpu_list("3-1"));
+    CHECK_FALSE(sim::parse_cpu_list("1,,2"));
+    CHECK_FALSE(sim::parse_cpu_list("a-b"));
+    CHECK_FALSE(sim::parse_cpu_list("0-"));
+}
+
+TEST_CASE("make_domains splits threads across nodes") {
+    const std::vector<int> allowed{0, 1, 2, 3, 4, 5, 6, 7};
+    const std::vector<std::vector<int>> nodes{{0, 1, 2, 3, 4, 5}, {6, 7}, {8, 9}};   // node 2 not allowed
+    const sim::PlacementPolicy numa{ .cores = {}, .per_node = true };
+
+    // Proportional to allowed CPUs per node; the largest remainder gets the leftover.
+    auto d = sim::make_domains(numa, 7, allowed, nodes);
+    REQUIRE(d.size() == 2);
+    CHECK(d[0].cpus.size() == 6);
+    CHECK(d[0].threads == 5);
+    CHECK(d[1].threads == 2);
+    CHECK(d[0].threads + d[1].threads == 7);
+
+    // 0 threads: one per CPU.
+    d = sim::make_domains(numa, 0, allowed, nodes);
+    CHECK(d[0].threads == 6);
+    CHECK(d[1].threads == 2);
+
+    // Fewer threads than domains: never more threads than requested; the
+    // domains left without one are dropped.
+    d = sim::make_domains(numa, 1, allowed, nodes);
+    REQUIRE(d.size() == 1);
+    CHECK(d[0].cpus.size() == 6);
+    CHECK(d[0].threads == 1);
+    const std::vector<std::vector<int>> three{{0, 1}, {2, 3}, {4, 5}};
+    d = sim::make_domains(numa, 2, allowed, three);
+    REQUIRE(d.size() == 2);
+    CHECK(d[0].threads + d[1].threads == 2);
+
+    // --cores restricts the domains to the given CPUs.
+    d = sim::make_domains(sim::PlacementPolicy{ .cores = {1, 6, 42}, .per_node = true }, 4, allowed, nodes);
+    REQUIRE(d.size() == 2);
+    CHECK(d[0].cpus == std::vector<int>{1});
+    CHECK(d[1].cpus == std::vector<int>{6});
+
+    // No NUMA information: a single domain over the allowed CPUs.
+    d = sim::make_domains(numa, 3, allowed, {});
+    REQUIRE(d.size() == 1);
+    CHECK(d[0].cpus == allowed);
+    CHECK(d[0].threads == 3);
+}
+
+TEST_CASE("numa_node_cpus reads sysfs and is empty without it") {
+    const auto dir = std::filesystem::temp_directory_path() / "schelling_stats_node";
+    std::filesystem::create_directories(dir / "node0");
+    std::filesystem::create_directories(dir / "node1");
+    std::ofstream(dir / "online") << "0-1\n";
+    std::ofstream(dir / "node0" / "cpulist") << "0-3\n";
+    std::ofstream(dir / "node1" / "cpulist") << "\n";   // memory-only node
+    const auto nodes = sim::detail::numa_node_cpus(dir.string());
+    REQUIRE(nodes.size() == 1);
+    CHECK(nodes[0] == std::vector<int>{0, 1, 2, 3});
+    std::filesystem::remove_all(dir);
+    CHECK(sim::detail::numa_node_cpus(dir.string()).empty());
+}
+
+TEST_CASE("run_sweep: per-task thresholds and per-point stats match separate runs") {
+    using Small = graphs::LollipopGraph<5, 45>;
+    using Large = graphs::LollipopGraph<10, 90>;
+    using Graphs = sim::GraphList<Small, Large>;
+    const std::vector<sim::SweepPoint> points{
+        { {1, 2}, 0.8, 0 }, { {2, 5}, 0.8, 0 }, { {1, 2}, 0.6, 1 }, { {2, 5}, 0.9, 1 } };
+    sim::JobConfig cfg{ .jobs = 40, .threads = 2 };
+    cfg.max_steps = 5000;
+    core::Xoshiro256ss master(7);
+    const auto stats = sim::run_sweep(Graphs{}, points, cfg, master);
+    REQUIRE(stats.size() == points.size());
+    CHECK(core::schelling::current_threshold().p == core::schelling::program_threshold.p);
+
+    core::Xoshiro256ss replay(7);
+    const std::uint64_t key = core::batch_key(replay);
+    for (std::size_t k = 0; k < points.size(); ++k) {
+        CAPTURE(k);
+        const auto& pt = points[k];
+        const core::schelling::ThresholdScope tau(pt.tau);
+        sim::HittingTimeStats expect;
+        auto run = [&](auto& g) {
+            for (std::size_t j = 0; j < cfg.jobs; ++j) {
+                g.reset();
+                core::Xoshiro256ss rng(core::job_seed(core::job_seed(key, k), j));
+                const auto r = *sim::run_schelling_process_until(g, pt.density, rng, cfg.minority, sim::NeverStop{}, cfg.max_steps);
+                if (r.censored) expect.record_censored(r.steps, r.unhappy);
+                else            expect.record(r.steps);
+            }
+        };
+        if (pt.graph == 0) { Small g; run(g); } else { Large g; run(g); }
+        std::ostringstream a, b;
+        stats[k].write(a);
+        expect.write(b);
+        CHECK(a.str() == b.str());
+    }
+    // Different thresholds give different laws at the same size and density.
+    CHECK(stats[0].settled().mean() != stats[1].settled().mean());
+
+    const auto rows = sim::summarize_sweep(Graphs{}, points, stats);
+    CHECK(rows[2].total_size == Large::TotalSize);
+    CHECK(rows[3].tau_q == 5);
+    const auto file = std::filesystem::temp_directory_path() / "schelling_stats_sweep.bin";
+    sim::SweepFileHeader h;
+    h.jobs = cfg.jobs;
+    sim::write_sweep_columns(file, h, rows);
+    sim::SweepFileHeader back_h;
+    const auto back = sim::read_sweep_columns(file, &back_h);
+    CHECK(back_h.points == points.size());
+    CHECK(back_h.jobs == cfg.jobs);
+    REQUIRE(back.size() == rows.size());
+    for (std::size_t k = 0; k < rows.size(); ++k) {
+        CHECK(back[k].density == rows[k].density);
+        CHECK(back[k].mean == rows[k].mean);
+        CHECK(back[k].p99 == rows[k].p99);
+        CHECK(back[k].runs == rows[k].runs);
+    }
+    std::filesystem::remove(file);
+}
+
+TEST_CASE("run_sweep with common random numbers pairs job j across points") {
+    using Graphs = sim::GraphList<graphs::LollipopGraph<10, 90>>;
+    const std::vector<sim::SweepPoint> points{ { {1, 2}, 0.8, 0 }, { {1, 2}, 0.8, 0 }, { {12, 25}, 0.8, 0 } };
+    sim::JobConfig cfg{ .jobs = 64, .threads = 2 };
+    cfg.common_random_numbers = true;
+    core::Xoshiro256ss master(11);
+    std::vector<std::uint64_t> times;
+    const auto stats = sim::run_sweep(Graphs{}, points, cfg, master, &times);
+    REQUIRE(times.size() == points.size() * cfg.jobs);
+
+    // Identical points see identical runs.
+    const sim::PairedDiff same = sim::paired_difference(times, cfg.jobs, 1, 0);
+    CHECK(same.pairs == cfg.jobs);
+    CHECK(same.mean == 0.0);
+    CHECK(same.stddev == 0.0);
+    CHECK(same.unpaired_half_width > 0.0);
+
+    // Job j uses job j's seed of run_jobs_hitting_time, split into streams.
+    core::Xoshiro256ss replay(11);
+    const std::uint64_t key = core::batch_key(replay);
+    const core::schelling::ThresholdScope tau(points[2].tau);
+    for (std::size_t j = 0; j < cfg.jobs; ++j) {
+        graphs::LollipopGraph<10, 90> g;
+        const std::uint64_t seed = core::job_seed(key, j);
+        core::Xoshiro256ss occ(core::stream_seed(seed, core::Stream::occupancy));
+        core::Xoshiro256ss col(core::stream_seed(seed, core::Stream::colors));
+        core::Xoshiro256ss dyn(core::stream_seed(seed, core::Stream::dynamics));
+        sim::initialize_graph_streams(g, 0.8, occ, col);
+        const auto r = *sim::continue_schelling_process(g, 0.8, dyn, 0, [](std::uint64_t) { return false; });
+        CHECK(times[2 * cfg.jobs + j] == (r.censored ? sim::sweep_no_time : r.steps));
+    }
+    const sim::PairedDiff d = sim::paired_difference(times, cfg.jobs, 2, 0);
+    REQUIRE(d.pairs == cfg.jobs);   // no budget: every run settles
+    CHECK(d.mean == doctest::Approx(stats[2].settled().mean() - stats[0].settled().mean()));
+}
+
+TEST_CASE("run_jobs_hitting_time keeps every finished job when the deadline cuts the batch") {
+    using G = graphs::LollipopGraph<10, 90>;
+    const tbb::global_control workers(tbb::global_control::max_allowed_parallelism, 8);
+    sim::JobConfig cfg{ .jobs = 10'000'000, .threads = 8 };
+    cfg.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(300);
+    core::Xoshiro256ss master(9);
+    std::vector<std::uint64_t> times;
+    const auto stats = sim::run_jobs_hitting_time<G>(cfg, master, &times);
+    // No step budget: every job that returned settled and has a time; the
+    // ones in flight at the deadline (at most one per worker) are censored.
+    const auto returned = static_cast<std::uint64_t>(
+        std::count_if(times.begin(), times.end(), [](std::uint64_t t) { return t != sim::no_hitting_time; }));
+    CHECK(stats.settled().count() == returned);
+    CHECK(stats.censored_count() == stats.interrupted_count());
+    CHECK(stats.interrupted_count() <= 8);
+    CHECK(returned > 0);
+    CHECK(stats.count() < cfg.jobs);
+}
+
+TEST_CASE("A job cut off by the deadline is censored at the step it reached") {
+    using G = graphs::LollipopGraph<1000, 200000>;
+    sim::JobConfig cfg{ .jobs = 1, .threads = 1 };
+    cfg.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(20);
+    core::Xoshiro256ss master(3);
+    const auto stats = sim::run_jobs_hitting_time<G>(cfg, master);
+
+    core::Xoshiro256ss replay(3);
+    auto g = std::make_unique<G>();
+    core::Xoshiro256ss rng(core::job_seed(core::batch_key(replay), 0));
+    const auto full = *sim::run_schelling_process_until(*g, cfg.density, rng, cfg.minority, sim::NeverStop{});
+    REQUIRE_FALSE(full.censored);
+    REQUIRE(stats.count() == 1);
+    CHECK(stats.interrupted_count() == 1);
+    CHECK(stats.censored_count() == 1);
+    CHECK(stats.censored().max() > 0);
+    CHECK(stats.censored().max() < full.steps);
+}
+
+TEST_CASE("run_jobs_hitting_time reports per-job times of its shard") {
+    using G = graphs::LollipopGraph<10, 90>;
+    sim::JobConfig cfg{ .jobs = 48, .threads = 2 };
+    cfg.max_steps = 200;
+    cfg.shard = sim::ShardSpec{ .index = 1, .count = 3 };
+    core::Xoshiro256ss master(5);
+    std::vector<std::uint64_t> times;
+    const auto stats = sim::run_jobs_hitting_time<G>(cfg, master, &times);
+    REQUIRE(times.size() == cfg.jobs);
+
+    core::Xoshiro256ss replay(5);
+    const std::uint64_t key = core::batch_key(replay);
+    std::uint64_t settled = 0;
+    for (std::size_t j = 0; j < cfg.jobs; ++j) {
+        CAPTURE(j);
+        if (j < cfg.shard.begin(cfg.jobs) || j >= cfg.shard.end(cfg.jobs)) {
+            CHECK(times[j] == sim::no_hitting_time);
+            continue;
+        }
+        G g;
+        core::Xoshiro256ss rng(core::job_seed(key, j));
+        const auto r = *sim::run_schelling_process_until(g, cfg.density, rng, cfg.minority, sim::NeverStop{}, cfg.max_steps);
+        CHECK(times[j] == (r.censored ? sim::no_hitting_time : r.steps));
+        settled += !r.censored;
+    }
+    CHECK(stats.settled().count() == settled);
+}
+
+int main(int argc, char** argv) {
+    doctest::Context ctx;
+    ctx.setOption("abort-after", 5); // stop test execution after 5 failed asserts
+    ctx.applyCommandLine(argc, argv);
+    int res = ctx.run(); // Run tests unless --no-run is specified
+    if (ctx.shouldExit()) { // Propagate the result of the tests
+        return res;
+    }
+    return res; // The result from doctest is propagated here as well
+}